@@ -3,14 +3,31 @@
 #include <stdlib.h>
 #include <math.h>
 #include <stdbool.h> // Para o tipo bool
+#include <string.h>
+#include <stdint.h>
 
 // Define M_PI se não estiver definido
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "agendador.h"
+#include "catalogo.h"
+#include "corpos_menores.h"
+#include "entrada.h"
+#include "esferas.h"
+#include "estado_gl.h"
+#include "gravacao.h"
+#include "headless.h"
+#include "inicio.h"
+#include "matematica.h"
+#include "memoria.h"
+#include "orbitas.h"
+#include "perfil.h"
+#include "rastro.h"
+#include "simulacao.h"
+#include "textura.h"
+#include "texto.h"
 
 /* Criar textura de tabuleiro de xadrez */
 #define checkImageWidth 64
@@ -19,21 +36,30 @@ static GLubyte checkImage[checkImageHeight][checkImageWidth][4];
 
 #ifdef GL_VERSION_1_1
 static GLuint texName;
-static GLuint earthTexName;
-static GLuint sunTexName;     // Textura para o sol
-static GLuint moonTexName;    // Textura para a lua
-static GLuint mercuryTexName; // Textura para Mercúrio
-static GLuint venusTexName;   // Textura para Vênus
-static GLuint marsTexName;    // Textura para Marte
-static GLuint jupiterTexName; // Textura para Júpiter
-static GLuint saturnTexName;  // Textura para Saturno
-static GLuint uranusTexName;  // Textura para Urano
-static GLuint neptuneTexName; // Textura para Netuno
 #endif
 
+// Catálogo de corpos celestes (pode ser trocado pela linha de comando)
+const char* catalogPath = "dados/sistema_solar.csv";
+int asteroidCount = 0; // Asteroides gerados no cinturão principal (--asteroides N)
+int targetFps = DEFAULT_TARGET_FPS; // Quadros por segundo com janela (--fps N, 0 = sem limite)
+bool vsyncEnabled = true;           // --sem-vsync desliga
+
+// Modo sem janela (--sem-janela): quadros desenhados em um FBO e gravados em disco
+HeadlessOptions headlessOptions = { .width = 800, .height = 600, .outputDir = "quadros",
+                                    .format = RECORDING_PNG };
+
+// Índice no array de objetos de cada corpo do catálogo (-1 = camada de corpos menores)
+int* catalogIndexMap = NULL;
+int catalogIndexCapacity = 0;
+
+// Posições dos objetos passadas à camada de corpos menores (x, y, z por objeto)
+float* parentPositions = NULL;
+
 // Variáveis da janela
 int windowWidth = 800;
 int windowHeight = 600;
+int viewportWidth = 800;  // Largura atual da área de desenho
+int viewportHeight = 600; // Altura atual da área de desenho (tela cheia ou janela)
 bool fullscreen = false;
 
 // Variáveis de posição da câmera
@@ -60,29 +86,48 @@ bool earthAxisView = false; // Modo de visualização do eixo da Terra
 float forwardX, forwardY, forwardZ;  // Vetor para frente
 float rightX, rightY, rightZ;        // Vetor para direita
 float upX, upY, upZ;                 // Vetor para cima
+bool cameraVectorsDirty = true;      // Yaw/pitch mudaram desde o último cálculo dos vetores
+
+// Matrizes calculadas na CPU uma vez por quadro (nada é lido de volta do OpenGL)
+Mat4 projectionMatrix;
+Mat4 viewMatrix;
+Mat4 viewProjectionMatrix;
+Frustum viewFrustum;
+Mat4 lastViewMatrix; // Visão do quadro anterior, para saber se a câmera se moveu
 
-// Definição do tipo de objeto celeste
+// Definição do tipo de objeto celeste. O movimento fica na simulação (simulacao.h);
+// aqui ficam a aparência e a cópia do estado usada no desenho.
 typedef struct {
-    float posX, posY, posZ;     // Posição
-    float velX, velY, velZ;     // Velocidade
-    float mass;                // Massa em kg
+    float posX, posY, posZ;     // Posição (copiada da simulação a cada passo)
+    OrbitPath orbit;           // Elementos orbitais em relação ao corpo pai (para desenhar a órbita)
+    int parent;                // Índice do corpo pai, -1 se não houver
     float radius;              // Raio em unidades GL
-    float rotationAngle;       // Ângulo de rotação em torno do próprio eixo
-    float rotationSpeed;       // Velocidade de rotação
-    GLuint texture;            // Textura do objeto
+    float rotationAngle;       // Ângulo de rotação em torno do próprio eixo (copiado da simulação)
+    float axialTilt;           // Inclinação axial em graus
+    int texture;               // Textura do objeto (identificador de textura.h, 0 = sem textura)
     float r, g, b;             // Cor do objeto (para backup se não tiver textura)
     bool fixed;                // Se o objeto está fixo no espaço (não se move pela gravidade)
     char name[50];             // Nome do objeto celeste
+    int label;                 // Rótulo com o nome (quads em cache no atlas de glifos)
 } CelestialObject;
 
-// Array de objetos celestes
-#define MAX_OBJECTS 10
-CelestialObject objects[MAX_OBJECTS];
+// Array de objetos celestes (cresce conforme o catálogo é lido); o índice é o id
+// do corpo na simulação
+CelestialObject* objects = NULL;
 int objectCount = 0;
+int objectCapacity = 0;
+
+// Órbitas e rotações dos corpos, e o estado lido dela depois de cada passo
+Simulation* simulation = NULL;
+SimBodyState* bodyStates = NULL;
+size_t simulationBytes = 0; // Contados em MEMORY_BODIES
 
 // Variáveis de física
 float timeStep = 0.1f;     // Fator de escala de tempo para ajustar velocidade da simulação
-float rotationAngles[MAX_OBJECTS]; // Ângulos de rotação para cada planeta
+double simulationTime = 0.0; // Soma dos passos já simulados (conferida na repetição da entrada)
+
+// As anomalias médias e os corpos menores avançam a esta fração do passo
+#define ORBIT_TIME_SCALE 0.2f
 
 // Flags de estado
 int lightEnabled = 1;  // Iluminação habilitada por padrão
@@ -95,123 +140,55 @@ GLfloat lightDiffuse[] = { 1.0f, 1.0f, 0.8f, 1.0f };  // Luz difusa amarelada pa
 GLfloat lightSpecular[] = { 1.0f, 1.0f, 1.0f, 1.0f }; // Componente especular branca
 GLfloat lightPosition[4];                            // Posição da luz, será atualizada durante o rendering
 
-// Raios orbitais para cada planeta (distâncias do Sol)
-const float orbitalRadii[] = {
-    0.0f,   // Sol (no centro)
-    5.0f,   // Mercúrio
-    7.0f,   // Vênus
-    10.0f,  // Terra
-    15.0f,  // Marte
-    25.0f,  // Júpiter
-    35.0f,  // Saturno
-    45.0f,  // Urano
-    55.0f   // Netuno
-};
+bool orbitPathsDirty = true; // Regerar o buffer das órbitas no próximo quadro
 
-// Velocidades orbitais de cada planeta (em graus por segundo)
-float orbitalSpeeds[] = {
-    0.0f,   // Sol (não orbita)
-    4.1f,   // Mercúrio (mais rápido)
-    3.0f,   // Vênus
-    2.5f,   // Terra
-    2.0f,   // Marte
-    1.0f,   // Júpiter
-    0.7f,   // Saturno
-    0.5f,   // Urano
-    0.4f    // Netuno (mais lento)
+// Passos de desenho dos corpos, na ordem em que são desenhados
+enum {
+    PASS_EMISSIVE, // Sol: sem iluminação, com material emissor
+    PASS_LIT,      // Planetas e luas iluminados
+    PASS_UNLIT     // Anéis: sem iluminação
 };
 
+// Item da fila de desenho. A chave ordena por passo, depois por textura, para que
+// itens com o mesmo estado fiquem juntos; o índice do objeto desempata.
+#define DRAW_KEY_PASS_SHIFT 60
+#define DRAW_KEY_TEXTURE_SHIFT 24
+#define DRAW_KEY_OBJECT_MAX ((1 << DRAW_KEY_TEXTURE_SHIFT) - 1)
+
+typedef struct {
+    uint64_t key;
+    int object;
+    GLuint texture; // 0 enquanto a textura do objeto não estiver pronta
+    bool ring;
+} DrawItem;
+
+DrawItem* drawQueue = NULL;
+int drawQueueCapacity = 0;
+GLUquadric* bodyQuadric = NULL; // Compartilhado por todas as esferas e anéis
+bool instancedSpheres = false;  // Corpos desenhados por esferas.c (OpenGL 3.3) em vez do pipeline fixo
+
+// Contagem de chamadas de estado do OpenGL (tecla E mostra a cada segundo)
+bool showStateStats = false;
+RenderStateStats lastStateStats;
+int lastStateStatsTime = 0;
+
 // Protótipos de funções
 void updateCamera();
 void calculateCameraVectors();
 void updatePhysics();
-void loadEarthTexture();
-void loadSunTexture();
-void loadMoonTexture();
-void loadMercuryTexture();
-void loadVenusTexture();
-void loadMarsTexture();
-void loadJupiterTexture();
-void loadSaturnTexture();
-void loadUranusTexture();
-void loadNeptuneTexture();
 void setupLighting();
 void toggleFullscreen();
 void resizeWindow(int width, int height);
-void addCelestialObject(float posX, float posY, float posZ, 
-                       float velX, float velY, float velZ,
-                       float mass, float radius, GLuint texture,
-                       float r, float g, float b, bool fixed,
-                       const char* name);
-void renderText3D(const char* text, float x, float y, float z);
+bool addCelestialObject(const CatalogEntry* entry, int texture);
+int catalogBodyLoaded(const CatalogEntry* entry, int index, void* userData);
+void syncBodyStates();
+void updateSmallBodyLayer(float timeScale);
+void setupProjection(int width, int height);
+void updateFrameMatrices();
+void updateFollowCamera();
+void mouseButton(int button, int state, int x, int y);
 void renderOrbitPaths(); // Nova função para desenhar as órbitas
-
-// Função genérica para carregar texturas
-void loadTexture(const char* filename, GLuint* texId) {
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(filename, &width, &height, &nrChannels, 0);
-    if (data) {
-        glGenTextures(1, texId);
-        glBindTexture(GL_TEXTURE_2D, *texId);
-        // Configurar parâmetros de wrapping e filtragem da textura
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                        GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Carregar os dados da textura (verificar se é RGB ou RGBA)
-        if (nrChannels == 3) {
-            gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, width, height, GL_RGB,
-                              GL_UNSIGNED_BYTE, data);
-        } else if (nrChannels == 4) {
-            gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, width, height, GL_RGBA,
-                              GL_UNSIGNED_BYTE, data);
-        }
-        stbi_image_free(data);
-    } else {
-        fprintf(stderr, "Falha ao carregar textura: %s\n", filename);
-    }
-}
-
-void loadEarthTexture() {
-    loadTexture("texturas/2k_earth_daymap.jpg", &earthTexName);
-}
-
-void loadSunTexture() {
-    loadTexture("texturas/2k_sun.jpg", &sunTexName);
-}
-
-void loadMoonTexture() {
-    loadTexture("moon_texture.jpg", &moonTexName);
-}
-
-void loadMercuryTexture() {
-    loadTexture("texturas/2k_mercury.jpg", &mercuryTexName);
-}
-
-void loadVenusTexture() {
-    loadTexture("texturas/2k_venus_surface.jpg", &venusTexName);
-}
-
-void loadMarsTexture() {
-    loadTexture("texturas/2k_mars.jpg", &marsTexName);
-}
-
-void loadJupiterTexture() {
-    loadTexture("texturas/2k_jupiter.jpg", &jupiterTexName);
-}
-
-void loadSaturnTexture() {
-    loadTexture("texturas/2k_saturn.jpg", &saturnTexName);
-}
-
-void loadUranusTexture() {
-    loadTexture("texturas/2k_uranus.jpg", &uranusTexName);
-}
-
-void loadNeptuneTexture() {
-    loadTexture("texturas/2k_neptune.jpg", &neptuneTexName);
-}
+void drawBodies();
 
 // Configurar iluminação
 void setupLighting() {
@@ -269,47 +246,114 @@ void resizeWindow(int width, int height) {
         windowHeight = height;
     }
     
+    setupProjection(width, height);
+    updateCamera();
+}
+
+// Configurar viewport e projeção (matriz calculada na CPU)
+void setupProjection(int width, int height) {
+    if (height <= 0) height = 1;
+    viewportWidth = width;
+    viewportHeight = height;
     glViewport(0, 0, (GLsizei)width, (GLsizei)height);
+    projectionMatrix = mat4Perspective(60.0f, (float)width / (float)height, 0.1f, 1000.0f); // Aumentado o far plane
     glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(60.0, (GLfloat)width / (GLfloat)height, 0.1, 1000.0); // Aumentado o far plane
+    glLoadMatrixf(projectionMatrix.m);
+    glMatrixMode(GL_MODELVIEW);
+}
+
+// Adicionar um objeto celeste ao sistema a partir de uma entrada do catálogo
+bool addCelestialObject(const CatalogEntry* entry, int texture) {
+    if (objectCount == objectCapacity) {
+        int newCapacity = objectCapacity ? objectCapacity * 2 : 16;
+        CelestialObject* newObjects = realloc(objects, newCapacity * sizeof(CelestialObject));
+        if (!newObjects) {
+            printf("Erro: Memória insuficiente para %d objetos.\n", newCapacity);
+            return false;
+        }
+        trackMemory(MEMORY_BODIES, (long long)(newCapacity - objectCapacity) * sizeof(CelestialObject));
+        objects = newObjects;
+        objectCapacity = newCapacity;
+    }
     
-    calculateCameraVectors();
+    // Na simulação o corpo segue a órbita em torno do pai (sem órbita, fica sobre ele)
+    SimBody body = {
+        .kind = SIM_BODY_ORBIT,
+        .mass = entry->mass,
+        .orbit = {
+            .semiMajorAxis = entry->orbit.semiMajorAxis, .eccentricity = entry->orbit.eccentricity,
+            .inclination = entry->orbit.inclination, .ascendingNode = entry->orbit.ascendingNode,
+            .argPeriapsis = entry->orbit.argPeriapsis
+        },
+        .parent = entry->parent,
+        .meanAnomaly = entry->meanAnomaly,
+        .orbitalSpeed = entry->orbitalSpeed,
+        // O Sol (o primeiro corpo) fica sem girar, como antes do catálogo
+        .rotationSpeed = objectCount == 0 ? 0.0f : entry->rotationSpeed
+    };
+    if (simAddBody(simulation, &body) != objectCount) {
+        printf("Erro: Memória insuficiente para %s.\n", entry->name);
+        return false;
+    }
     
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    CelestialObject obj = {
+        .posX = 0.0f, .posY = 0.0f, .posZ = 0.0f,
+        .orbit = entry->orbit,
+        .parent = entry->parent,
+        .radius = entry->radius,
+        .rotationAngle = 0.0f,
+        .axialTilt = entry->axialTilt,
+        .texture = texture,
+        .r = entry->r, .g = entry->g, .b = entry->b,
+        .fixed = entry->orbit.semiMajorAxis == 0.0f, // Sem órbita, fica parado
+        .name = ""
+    };
+    strcpy(obj.name, entry->name);
+    obj.label = createLabel(entry->name);
+    objects[objectCount++] = obj;
+    return true;
+}
+
+// Chamada pelo leitor do catálogo para cada corpo
+int catalogBodyLoaded(const CatalogEntry* entry, int index, void* userData) {
+    (void)userData;
+    if (index >= catalogIndexCapacity) {
+        int newCapacity = catalogIndexCapacity ? catalogIndexCapacity * 2 : 1024;
+        int* newMap = realloc(catalogIndexMap, newCapacity * sizeof(int));
+        if (!newMap) return 0;
+        trackMemory(MEMORY_INDEXES, (long long)(newCapacity - catalogIndexCapacity) * sizeof(int));
+        catalogIndexMap = newMap;
+        catalogIndexCapacity = newCapacity;
+    }
     
-    // Aplicar rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X)
-    glRotatef(cameraPitch, 1.0f, 0.0f, 0.0f);
-    glRotatef(cameraYaw, 0.0f, 1.0f, 0.0f);
+    // O pai precisa ser um objeto completo (corpos menores não têm satélites)
+    int parent = entry->parent >= 0 ? catalogIndexMap[entry->parent] : -1;
+    if (entry->parent >= 0 && parent < 0) {
+        fprintf(stderr, "Aviso: %s ignorado, o pai é um corpo menor\n", entry->name);
+        catalogIndexMap[index] = -1;
+        return 1;
+    }
     
-    // Depois aplicar translação
-    glTranslatef(cameraX, cameraY, cameraZ);
+    // Corpos pequenos sem textura vão para a camada de pontos
+    if (entry->radius < SMALL_BODY_RADIUS && entry->texture[0] == '\0') {
+        catalogIndexMap[index] = -1;
+        return addSmallBody(entry, parent);
+    }
+    
+    CatalogEntry body = *entry;
+    body.parent = parent;
+    catalogIndexMap[index] = objectCount;
+    return addCelestialObject(&body, requestTexture(entry->texture));
 }
 
-// Adicionar um objeto celeste ao sistema
-void addCelestialObject(float posX, float posY, float posZ, 
-                       float velX, float velY, float velZ,
-                       float mass, float radius, GLuint texture,
-                       float r, float g, float b, bool fixed,
-                       const char* name) {
-    if (objectCount < MAX_OBJECTS) {
-        CelestialObject obj = {
-            .posX = posX, .posY = posY, .posZ = posZ,
-            .velX = velX, .velY = velY, .velZ = velZ,
-            .mass = mass,
-            .radius = radius,
-            .rotationAngle = 0.0f,
-            .rotationSpeed = 1.0f, // velocidade padrão de rotação
-            .texture = texture,
-            .r = r, .g = g, .b = b,
-            .fixed = fixed,
-            .name = ""
-        };
-        strcpy(obj.name, name);
-        objects[objectCount++] = obj;
-    } else {
-        printf("Erro: Número máximo de objetos atingido.\n");
+// Copiar posições e rotações da simulação para os objetos desenhados
+void syncBodyStates() {
+    int count = simGetState(simulation, bodyStates, objectCount);
+    for (int i = 0; i < count; i++) {
+        objects[i].posX = (float)bodyStates[i].position[0];
+        objects[i].posY = (float)bodyStates[i].position[1];
+        objects[i].posZ = (float)bodyStates[i].position[2];
+        objects[i].rotationAngle = bodyStates[i].rotationAngle;
     }
 }
 
@@ -317,177 +361,122 @@ void addCelestialObject(float posX, float posY, float posZ,
 void updatePhysics() {
     if (simulationPaused) return;
     
-    // Atualizar a posição de cada planeta (exceto o Sol)
-    for (int i = 1; i < objectCount; i++) {
-        // Incrementar o ângulo de rotação específico deste planeta
-        rotationAngles[i] += orbitalSpeeds[i] * timeStep * 0.2f;
-        if (rotationAngles[i] > 360.0f) {
-            rotationAngles[i] -= 360.0f;
-        }
-        
-        // Atualizar a posição do planeta para orbitar ao redor do Sol
-        objects[i].posX = orbitalRadii[i] * cos(rotationAngles[i] * M_PI / 180.0f);
-        objects[i].posZ = orbitalRadii[i] * sin(rotationAngles[i] * M_PI / 180.0f);
-        // Manter os planetas no plano XZ
-        objects[i].posY = 0.0f;
-        
-        // Também atualizar a rotação do próprio planeta
-        objects[i].rotationAngle += objects[i].rotationSpeed * timeStep;
-        if (objects[i].rotationAngle > 360.0f) {
-            objects[i].rotationAngle -= 360.0f;
-        }
+    // Anomalias, posições (pais antes dos filhos) e rotações, na fase "posicoes"
+    simSetTimeStep(simulation, timeStep);
+    if (!simStep(simulation, 1)) {
+        fprintf(stderr, "Erro: Memória insuficiente para o passo da simulação.\n");
     }
+    simulationTime = simTime(simulation);
+    syncBodyStates();
+    
+    traceBegin("corpos menores");
+    updateSmallBodyLayer(timeStep * ORBIT_TIME_SCALE);
+    traceEnd();
+}
+
+// Avançar os corpos menores e escrever suas posições no buffer de vértices
+void updateSmallBodyLayer(float timeScale) {
+    if (smallBodyCount() == 0) return;
+    
+    for (int i = 0; i < objectCount; i++) {
+        parentPositions[i * 3 + 0] = objects[i].posX;
+        parentPositions[i * 3 + 1] = objects[i].posY;
+        parentPositions[i * 3 + 2] = objects[i].posZ;
+    }
+    updateSmallBodies(timeScale, parentPositions);
 }
 
 void init(void) {
+    traceBegin("init");
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glShadeModel(GL_SMOOTH); // Sombreamento suave
     glEnable(GL_DEPTH_TEST);
     
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     
-    // Carregar as texturas
-    loadEarthTexture();
-    loadSunTexture();
-    //loadMoonTexture();
-    loadMercuryTexture();
-    loadVenusTexture();
-    loadMarsTexture();
-    loadJupiterTexture();
-    loadSaturnTexture();
-    loadUranusTexture();
-    loadNeptuneTexture();
+    // Criar o atlas de glifos usado pelos rótulos
+    traceBegin("atlas de glifos");
+    initTextRenderer();
+    traceEnd();
+    markStartupPhase("atlas de glifos");
+    
+    // Shader e buffers da camada de corpos menores
+    traceBegin("shaders");
+    initSmallBodies();
+    initProfiler();
+    traceEnd();
+    markStartupPhase("shaders");
     
     // Configurar iluminação
     setupLighting();
     
     // Limpar o array de objetos celestes
     objectCount = 0;
-    
-    // Inicializar ângulos de rotação
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        rotationAngles[i] = 0.0f;
+    SimulationConfig config = simDefaultConfig();
+    config.timeStep = timeStep;
+    config.orbitTimeScale = ORBIT_TIME_SCALE;
+    simulation = simCreate(&config);
+    if (!simulation) {
+        fprintf(stderr, "Erro: Memória insuficiente para a simulação\n");
+        exit(1);
+    }
+    if (tracingEnabled) simSetPhaseHooks(simulation, traceBeginSpan, traceEndSpan);
+    
+    // === Carregar objetos celestes (Sol e planetas) do catálogo ===
+    // As texturas são só registradas durante a leitura e carregadas todas juntas depois
+    traceBegin("catalogo");
+    int loaded = loadCatalog(catalogPath, catalogBodyLoaded, NULL);
+    traceEnd();
+    markStartupPhase("catálogo");
+    if (loaded <= 0) {
+        fprintf(stderr, "Erro: Nenhum objeto celeste carregado de %s\n", catalogPath);
+        exit(1);
+    }
+    printf("Catálogo %s: %d objetos carregados\n", catalogPath, loaded);
+    
+    // Decodificar as texturas em segundo plano; até chegarem os corpos usam a cor.
+    // Com o desenho instanciado, as texturas de mesmo tamanho ficam em um array.
+    traceBegin("esferas e texturas");
+    instancedSpheres = initSphereRenderer();
+    startTextureLoading(instancedSpheres);
+    traceEnd();
+    markStartupPhase("esferas e texturas");
+    
+    // Cinturão de asteroides gerado ao redor do primeiro objeto (o Sol)
+    if (asteroidCount > 0) {
+        traceBegin("asteroides");
+        generateAsteroidBelt(asteroidCount, 0, 12345);
+        traceEnd();
+    }
+    if (smallBodyCount() > 0) {
+        printf("Corpos menores: %d\n", smallBodyCount());
     }
     
-    // === Criar objetos celestes (Sol e planetas) ===
-    
-    // Sol (fixo no centro)
-    addCelestialObject(
-        0.0f, 0.0f, 0.0f,     // posição
-        0.0f, 0.0f, 0.0f,     // velocidade
-        1.989e30,             // massa do Sol em kg
-        3.0f,                 // raio visual
-        sunTexName,           // textura
-        1.0f, 1.0f, 0.0f,     // cor amarela (backup)
-        true,                 // fixo, não se move
-        "Sol"                // nome do objeto
-    );
-    // Ajustar rotação do Sol
-    objects[objectCount-1].rotationSpeed = 0.5f;  // Rotação mais lenta para o Sol
-    
-    // Mercúrio
-    addCelestialObject(
-        orbitalRadii[1], 0.0f, 0.0f,     // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        3.3011e23,            // massa em kg
-        0.4f,                 // raio visual
-        mercuryTexName,       // textura
-        0.7f, 0.7f, 0.7f,     // cor cinza (backup)
-        true,                 // fixo inicialmente
-        "Mercurio"          // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 0.1f;  // Mercúrio é lento (58.6 dias terrestres)
-    
-    // Vênus
-    addCelestialObject(
-        orbitalRadii[2], 0.0f, 0.0f,     // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        4.8675e24,            // massa em kg
-        0.9f,                 // raio visual
-        venusTexName,         // textura
-        0.9f, 0.7f, 0.0f,     // cor laranja-amarelada (backup)
-        true,                 // fixo inicialmente
-        "Venus"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 0.05f;  // Vênus é muito lento (243 dias terrestres) e retrógrado
-    
-    // Terra
-    addCelestialObject(
-        orbitalRadii[3], 0.0f, 0.0f,    // posição (usar raio orbital global) 
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        5.972e24,             // massa da Terra em kg
-        1.0f,                 // raio
-        earthTexName,         // textura
-        0.0f, 0.5f, 1.0f,     // cor azul (backup)
-        true,                 // fixo inicialmente
-        "Terra"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 2.0f;  // Rotação da Terra (1 dia)
-    
-    // Marte
-    addCelestialObject(
-        orbitalRadii[4], 0.0f, 0.0f,    // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        6.4171e23,            // massa em kg
-        0.5f,                 // raio visual
-        marsTexName,          // textura
-        1.0f, 0.3f, 0.0f,     // cor vermelha (backup)
-        true,                 // fixo inicialmente
-        "Marte"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 1.9f;  // Marte (24.6 horas)
-    
-    // Júpiter
-    addCelestialObject(
-        orbitalRadii[5], 0.0f, 0.0f,    // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        1.8982e27,            // massa em kg
-        2.0f,                 // raio visual
-        jupiterTexName,       // textura
-        0.9f, 0.7f, 0.5f,     // cor bege (backup)
-        true,                 // fixo inicialmente
-        "Jupiter"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 5.0f;  // Júpiter é rápido (9.9 horas)
-    
-    // Saturno
-    addCelestialObject(
-        orbitalRadii[6], 0.0f, 0.0f,    // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        5.6834e26,            // massa em kg
-        1.8f,                 // raio visual
-        saturnTexName,        // textura
-        0.9f, 0.8f, 0.5f,     // cor amarelada (backup)
-        true,                 // fixo inicialmente
-        "Saturno"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 4.5f;  // Saturno é rápido (10.7 horas)
-    
-    // Urano
-    addCelestialObject(
-        orbitalRadii[7], 0.0f, 0.0f,    // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        8.6810e25,            // massa em kg
-        1.5f,                 // raio visual
-        uranusTexName,        // textura
-        0.5f, 0.8f, 0.9f,     // cor azul-esverdeada (backup)
-        true,                 // fixo inicialmente
-        "Urano"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = -3.0f;  // Urano tem rotação retrógrada (17.2 horas)
-    
-    // Netuno
-    addCelestialObject(
-        orbitalRadii[8], 0.0f, 0.0f,    // posição (usar raio orbital global)
-        0.0f, 0.0f, 0.0f,     // velocidade (será calculada na física)
-        1.02413e26,           // massa em kg
-        1.4f,                 // raio visual
-        neptuneTexName,       // textura
-        0.0f, 0.0f, 0.8f,     // cor azul escuro (backup)
-        true,                 // fixo inicialmente
-        "Netuno"            // nome do objeto
-    );
-    objects[objectCount-1].rotationSpeed = 3.5f;  // Netuno (16.1 horas)
+    // Posições iniciais, calculadas pela simulação a partir das anomalias do catálogo
+    bodyStates = malloc(objectCount * sizeof(SimBodyState));
+    if (!bodyStates) {
+        fprintf(stderr, "Erro: Memória insuficiente para o estado dos corpos\n");
+        exit(1);
+    }
+    trackMemory(MEMORY_BODIES, (long long)objectCount * sizeof(SimBodyState));
+    trackMemorySize(MEMORY_BODIES, &simulationBytes, simMemoryBytes(simulation));
+    syncBodyStates();
+    parentPositions = malloc(objectCount * 3 * sizeof(float));
+    if (parentPositions) trackMemory(MEMORY_BODIES, (long long)objectCount * 3 * sizeof(float));
+    updateSmallBodyLayer(0.0f);
+    orbitPathsDirty = true;
+    
+    // Um único quadric para todas as esferas e anéis
+    bodyQuadric = gluNewQuadric();
+    gluQuadricTexture(bodyQuadric, GL_TRUE);
+    gluQuadricNormals(bodyQuadric, GLU_SMOOTH);
+    gluQuadricOrientation(bodyQuadric, GLU_OUTSIDE);
+    gluQuadricDrawStyle(bodyQuadric, GLU_FILL);
+    
+    // O carregamento de texturas e a iluminação mexeram no estado sem passar pelo cache
+    invalidateRenderState();
+    traceEnd();
+    markStartupPhase("cena");
     
     // Imprimir instruções
     printf("\n--- Controles do Sistema Solar ---\n");
@@ -498,6 +487,11 @@ void init(void) {
     printf("L: Alternar iluminação\n");
     printf("F: Alternar tela cheia\n");
     printf("O: Alternar linhas das órbitas\n");
+    printf("E: Mostrar chamadas de estado do OpenGL por quadro\n");
+    printf("V: Gravar quadros em disco (liga/desliga)\n");
+    printf("H: Mostrar tempos de cada fase do quadro e a memória\n");
+    printf("K: Escrever o rastro de execução (com --rastro)\n");
+    printf("Clique: Seguir o objeto sob o cursor\n");
     printf("[/]: Diminuir/aumentar largura da janela\n");
     printf("-/+: Diminuir/aumentar altura da janela\n");
     printf(",/.: Diminuir/aumentar velocidade da simulação\n");
@@ -508,6 +502,10 @@ void init(void) {
 
 // Calcular vetores de direção da câmera com base em yaw e pitch
 void calculateCameraVectors() {
+    // A trigonometria só é refeita quando yaw/pitch mudaram
+    if (!cameraVectorsDirty) return;
+    cameraVectorsDirty = false;
+    
     // Calcular o novo vetor Forward
     forwardX = -sin(cameraYaw * M_PI / 180.0f) * cos(cameraPitch * M_PI / 180.0f);
     forwardY = sin(cameraPitch * M_PI / 180.0f);
@@ -540,261 +538,224 @@ void calculateCameraVectors() {
     upZ /= lenUp;
 }
 
+// Marcar a câmera como alterada; vetores e matrizes são recalculados uma vez no próximo quadro
 void updateCamera() {
+    cameraVectorsDirty = true;
+    if (!headlessOptions.enabled) requestRedraw();
+}
+
+// Se estiver no modo de seguir planeta, atualizar posição da câmera
+void updateFollowCamera() {
+    if (cameraFollowMode < 0 || cameraFollowMode >= objectCount) return;
+    
     calculateCameraVectors();
     
-    // Se estiver no modo de seguir planeta, atualizar posição da câmera
-    if (cameraFollowMode >= 0 && cameraFollowMode < objectCount) {
-        // Obter a posição do planeta atual
-        float planetX = objects[cameraFollowMode].posX;
-        float planetY = objects[cameraFollowMode].posY;
-        float planetZ = objects[cameraFollowMode].posZ;
+    // Obter a posição do planeta atual
+    float planetX = objects[cameraFollowMode].posX;
+    float planetY = objects[cameraFollowMode].posY;
+    float planetZ = objects[cameraFollowMode].posZ;
+    
+    if (earthAxisView && strcmp(objects[cameraFollowMode].name, "Terra") == 0) {
+        // Modo de visualização do eixo da Terra
+        float distance = 3.0f; // Aplicar zoom na distância
+        float height = 2.0f;   // Aplicar zoom na altura
         
-        if (earthAxisView && strcmp(objects[cameraFollowMode].name, "Terra") == 0) {
-            // Modo de visualização do eixo da Terra
-            float distance = 3.0f; // Aplicar zoom na distância
-            float height = 2.0f;   // Aplicar zoom na altura
-            
-            // Calcular ângulo de rotação da Terra
-            float angle = objects[cameraFollowMode].rotationAngle * M_PI / 180.0f;
-            
-            // Posicionar a câmera em uma órbita fixa ao redor do eixo da Terra
-            cameraX = planetX + distance * cos(angle);
-            cameraY = planetY + height;
-            cameraZ = planetZ + distance * sin(angle);
-            
-            // Fazer a câmera olhar para o centro da Terra
-            float dx = planetX - cameraX;
-            float dy = planetY - cameraY;
-            float dz = planetZ - cameraZ;
-            
-            // Calcular os ângulos para olhar para a Terra
-            float dist = sqrt(dx*dx + dz*dz);
-            cameraPitch = -atan2(dy, dist) * 180.0f / M_PI;
-            cameraYaw = atan2(dz, dx) * 180.0f / M_PI;
-        } else {
-            // Modo normal de seguir planeta
-            float distance = 5.0f; // Aplicar zoom na distância
-            cameraX = planetX - forwardX * distance;
-            cameraY = planetY - forwardY * distance;
-            cameraZ = planetZ - forwardZ * distance;
-        }
+        // Calcular ângulo de rotação da Terra
+        float angle = objects[cameraFollowMode].rotationAngle * M_PI / 180.0f;
+        
+        // Posicionar a câmera em uma órbita fixa ao redor do eixo da Terra
+        cameraX = planetX + distance * cos(angle);
+        cameraY = planetY + height;
+        cameraZ = planetZ + distance * sin(angle);
+        
+        // Fazer a câmera olhar para o centro da Terra
+        float dx = planetX - cameraX;
+        float dy = planetY - cameraY;
+        float dz = planetZ - cameraZ;
+        
+        // Calcular os ângulos para olhar para a Terra
+        float dist = sqrt(dx*dx + dz*dz);
+        cameraPitch = -atan2(dy, dist) * 180.0f / M_PI;
+        cameraYaw = atan2(dz, dx) * 180.0f / M_PI;
+        cameraVectorsDirty = true;
+    } else {
+        // Modo normal de seguir planeta
+        float distance = 5.0f; // Aplicar zoom na distância
+        cameraX = planetX - forwardX * distance;
+        cameraY = planetY - forwardY * distance;
+        cameraZ = planetZ - forwardZ * distance;
     }
+}
+
+// Calcular visão, visão-projeção e frustum uma vez por quadro
+void updateFrameMatrices() {
+    updateFollowCamera();
+    calculateCameraVectors();
     
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Aplicar rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X)
-    glRotatef(cameraPitch, 1.0f, 0.0f, 0.0f);
-    glRotatef(cameraYaw, 0.0f, 1.0f, 0.0f);
-    
-    // Depois aplicar translação
-    glTranslatef(cameraX, cameraY, cameraZ);
+    // Rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X), depois a translação
+    Mat4 pitch = mat4RotationX(cameraPitch);
+    Mat4 yaw = mat4RotationY(cameraYaw);
+    Mat4 rotation = mat4Multiply(&pitch, &yaw);
+    Mat4 translation = mat4Translation(cameraX, cameraY, cameraZ);
+    viewMatrix = mat4Multiply(&rotation, &translation);
     
-    glutPostRedisplay();
+    viewProjectionMatrix = mat4Multiply(&projectionMatrix, &viewMatrix);
+    viewFrustum = frustumFromMatrix(&viewProjectionMatrix);
 }
 
 void display(void) {
+    // Eventos gravados deste quadro; acabada a repetição, o programa termina
+    if (!beginInputFrame(simulationTime)) {
+        stopRecording();
+        exit(0);
+    }
+    traceBegin("quadro");
+    beginProfileFrame();
+    
     // Atualiza a física
+    profileBegin(PHASE_PHYSICS);
     updatePhysics();
+    profileEnd(PHASE_PHYSICS);
+    
+    // Calcula as matrizes da câmera deste quadro
+    updateFrameMatrices();
+    bool cameraMoved = memcmp(&viewMatrix, &lastViewMatrix, sizeof(Mat4)) != 0;
+    lastViewMatrix = viewMatrix;
     
     // Limpa o buffer de cores e profundidade
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    // Atualiza a posição da luz (sol)
+    // Atualiza a posição da luz (sol), transformada pela matriz de visão
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(viewMatrix.m);
     GLfloat lightPosition[] = { 0.0f, 0.0f, 0.0f, 1.0f };
     glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
 
     // Configurar iluminação global
-    if (lightEnabled) {
-        glEnable(GL_LIGHTING);
-        glEnable(GL_LIGHT0);
-    } else {
-        glDisable(GL_LIGHTING);
-        glDisable(GL_LIGHT0);
-    }
+    setCapability(GL_LIGHTING, lightEnabled);
+    setCapability(GL_LIGHT0, lightEnabled);
     
     // Desenhar as órbitas dos planetas
+    profileBegin(PHASE_ORBITS);
     renderOrbitPaths();
+    profileEnd(PHASE_ORBITS);
+    
+    // Desenha os objetos celestes, agrupados por estado
+    profileBegin(PHASE_BODIES);
+    drawBodies();
+    profileEnd(PHASE_BODIES);
+    
+    // Enviar os níveis de textura pedidos pelos corpos visíveis
+    profileBegin(PHASE_TEXTURES);
+    bool texturesPending = streamTextures();
+    profileEnd(PHASE_TEXTURES);
+    
+    setCapability(GL_TEXTURE_2D, false);
+    glLoadMatrixf(viewMatrix.m);
+    
+    // Asteroides e cometas como pontos, todos em uma chamada
+    profileBegin(PHASE_SMALL_BODIES);
+    drawSmallBodies(&viewMatrix, &projectionMatrix, viewportHeight);
+    profileEnd(PHASE_SMALL_BODIES);
+    
+    // Desenhar todos os rótulos de uma vez, sem iluminação, virados para a câmera.
+    // Os eixos direita e cima da câmera são as duas primeiras linhas da matriz de visão.
+    Vec3 cameraRight = mat4Row3(&viewMatrix, 0);
+    Vec3 cameraUp = mat4Row3(&viewMatrix, 1);
+    float labelRight[3] = { cameraRight.x, cameraRight.y, cameraRight.z };
+    float labelUp[3] = { cameraUp.x, cameraUp.y, cameraUp.z };
+    setCapability(GL_LIGHTING, false);
+    profileBegin(PHASE_LABELS);
+    drawQueuedLabels(labelRight, labelUp);
+    profileEnd(PHASE_LABELS);
+    
+    // Tempos dos quadros anteriores por cima de tudo (tecla H)
+    drawProfilerHud(viewportWidth, viewportHeight);
+    invalidateRenderState(); // Os rótulos e o HUD trocam textura, cor e mistura diretamente
     
-    // Desenha os objetos celestes
-    for (int i = 0; i < objectCount; i++) {
-        glPushMatrix();
-        
-        // Posiciona o objeto
-        glTranslatef(objects[i].posX, objects[i].posY, objects[i].posZ);
-        
-        // O sol (primeiro objeto) é autoluminoso, desligar iluminação para ele
-        if (i == 0) {
-            glDisable(GL_LIGHTING);
-            // Configurar o Sol para emitir luz própria (material emissor)
-            GLfloat emission[] = {1.0f, 0.9f, 0.2f, 1.0f};
-            glMaterialfv(GL_FRONT, GL_EMISSION, emission);
-        } else if (lightEnabled) {
-            glEnable(GL_LIGHTING);
-            // Desativar emissão para os planetas
-            GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
-            glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
-        }
-        
-        // Usar textura se o objeto tiver uma textura válida
-        if (objects[i].texture > 0) {
-            glEnable(GL_TEXTURE_2D);
-            glBindTexture(GL_TEXTURE_2D, objects[i].texture);
-            glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-        } else {
-            glDisable(GL_TEXTURE_2D);
-        }
-        
-        // Definir cor (será usada como fator de multiplicação para a textura)
-        glColor3f(objects[i].r, objects[i].g, objects[i].b);
-        
-        // Corrigir a orientação das texturas antes de aplicar a rotação do planeta
-        // Girar 90 graus em torno do eixo X para alinhar corretamente as texturas
-        glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
-        
-        // Adicionar inclinações axiais para planetas específicos
-        if (strcmp(objects[i].name, "Terra") == 0) {
-            // Terra tem uma inclinação de 23.5 graus
-            glRotatef(23.5f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Urano") == 0) {
-            // Urano tem uma inclinação extrema de cerca de 98 graus
-            glRotatef(98.0f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Saturno") == 0) {
-            // Saturno tem uma inclinação de 26.7 graus
-            glRotatef(26.7f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Netuno") == 0) {
-            // Netuno tem uma inclinação de cerca de 28 graus
-            glRotatef(28.0f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Marte") == 0) {
-            // Marte tem uma inclinação de 25 graus
-            glRotatef(25.0f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Jupiter") == 0) {
-            // Júpiter tem uma inclinação de 3.1 graus
-            glRotatef(3.1f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Venus") == 0) {
-            // Vênus tem uma rotação retrógrada com inclinação de 177 graus
-            glRotatef(177.0f, 1.0f, 0.0f, 0.0f);
-        } else if (strcmp(objects[i].name, "Mercurio") == 0) {
-            // Mercúrio tem uma pequena inclinação de 0.034 graus
-            glRotatef(0.034f, 1.0f, 0.0f, 0.0f);
-        }
-        
-        // Rotação do objeto em torno do próprio eixo
-        // Rotacionar em torno do eixo Z que agora está alinhado com o polo norte-sul
-        glRotatef(objects[i].rotationAngle, 0.0f, 0.0f, 1.0f);
-        
-        // Criar uma esfera para o objeto
-        GLUquadric* quadric = gluNewQuadric();
-        gluQuadricTexture(quadric, GL_TRUE);
-        gluQuadricNormals(quadric, GLU_SMOOTH);
-        
-        // Definir a orientação da textura para os quadrics
-        gluQuadricOrientation(quadric, GLU_OUTSIDE);
-        gluQuadricDrawStyle(quadric, GLU_FILL);
-        
-        // Desenhar a esfera
-        gluSphere(quadric, objects[i].radius, 32, 32);
-        gluDeleteQuadric(quadric);
-        
-        // Adicionar anéis para Saturno
-        if (strcmp(objects[i].name, "Saturno") == 0) {
-            // Desfazer a rotação do planeta para os anéis
-            glRotatef(-objects[i].rotationAngle, 0.0f, 0.0f, 1.0f);
-            
-            // Ajustar a orientação para os anéis (desfazendo a rotação em X)
-            glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
-            
-            // Rotacionar os anéis apropriadamente
-            glRotatef(75.0f, 1.0f, 0.0f, 0.0f);
-            
-            // Criar um novo quadric para os anéis
-            GLUquadric* ringQuadric = gluNewQuadric();
-            gluQuadricTexture(ringQuadric, GL_TRUE);
-            gluQuadricNormals(ringQuadric, GLU_SMOOTH);
-            
-            // Desabilitar iluminação para os anéis
-            glDisable(GL_LIGHTING);
-            
-            // Definir cor dos anéis (tom amarelado)
-            glColor3f(0.9f, 0.8f, 1.0f);
-            
-            // Desenhar três anéis com diferentes raios
-            float innerRadius = objects[i].radius * 1.2f;
-            float outerRadius = objects[i].radius * 2.0f;
-            float ringThickness = 0.05f;
-            
-            // Anel médio
-            gluDisk(ringQuadric, innerRadius + ringThickness * 2, 
-                   innerRadius + ringThickness * 3, 32, 1);
-            
-            // 5 anéis entre o médio e o externo
-            float spacing = (outerRadius - (innerRadius + ringThickness * 3)) / 6.0f;
-            for(int j = 0; j < 5; j++) {
-                float currentRadius = innerRadius + ringThickness * 3 + spacing * (j + 1);
-                gluDisk(ringQuadric, currentRadius, currentRadius + ringThickness, 32, 1);
-            }
-            
-            // Anel externo
-            gluDisk(ringQuadric, outerRadius - ringThickness, 
-                   outerRadius, 32, 1);
-            
-            // Reabilitar iluminação
-            if (lightEnabled) {
-                glEnable(GL_LIGHTING);
-            }
-            
-            gluDeleteQuadric(ringQuadric);
+    // Resetar emissão
+    GLfloat noEmission[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    setMaterialEmission(noEmission);
+    
+    // Contagem de chamadas de estado deste quadro
+    lastStateStats = beginRenderStateFrame();
+    if (showStateStats) {
+        int now = glutGet(GLUT_ELAPSED_TIME);
+        if (now - lastStateStatsTime >= 1000) {
+            printf("Chamadas de estado GL: %d enviadas, %d evitadas\n",
+                   lastStateStats.issued, lastStateStats.skipped);
+            lastStateStatsTime = now;
         }
-        
-        glPopMatrix();
-        
-        // Renderizar o nome do planeta acima dele (posição ajustada para ficar mais próximo)
-        renderText3D(objects[i].name, objects[i].posX, objects[i].posY + objects[i].radius + 0.5f, objects[i].posZ);
     }
     
-    glDisable(GL_TEXTURE_2D);
+    // Ler o quadro para a gravação (se ativa) antes da troca de buffers
+    traceBegin("captura");
+    captureFrame();
+    traceEnd();
     
-    // Resetar emissão
-    GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
+    // Sem janela o quadro fica no FBO e quem chamou decide o próximo
+    if (headlessOptions.enabled) {
+        endProfileFrame();
+        traceEnd();
+        return;
+    }
     
     // Usar double buffering para animação mais suave
+    profileBegin(PHASE_SWAP);
     glutSwapBuffers();
+    profileEnd(PHASE_SWAP);
+    endProfileFrame();
+    traceEnd();
+    
+    // O primeiro quadro fecha a medição da inicialização (--medir-inicio sai aqui)
+    if (measureStartup) glFinish();
+    if (firstFramePresented()) {
+        stopRecording();
+        exit(0);
+    }
     
-    // Solicitar redesenho para animação
-    glutPostRedisplay();
+    // Próximo quadro no ritmo da taxa alvo. Pausado, com a câmera parada e nada
+    // carregando ou gravando, só a entrada do usuário pede outro quadro.
+    scheduleNextFrame(!simulationPaused || cameraMoved || texturesPending || recordingActive()
+                      || inputReplayActive());
+}
+
+// Liga ou desliga a gravação dos quadros da janela (pasta e formato de --saida e --formato)
+void toggleRecording() {
+    if (recordingActive()) {
+        stopRecording();
+    } else {
+        startRecording(headlessOptions.outputDir, headlessOptions.format,
+                       glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
+    }
 }
 
 void reshape(int w, int h) {
+    // Os quadros gravados têm todos o tamanho do início da gravação
+    if (recordingActive()) {
+        printf("Gravação interrompida: a janela mudou de tamanho\n");
+        stopRecording();
+    }
+    
     if (!fullscreen) {
         windowWidth = w;
         windowHeight = h;
     }
     
-    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(60.0, (GLfloat)w / (GLfloat)h, 0.1, 1000.0);
-    
-    calculateCameraVectors();
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Aplicar rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X)
-    glRotatef(cameraPitch, 1.0f, 0.0f, 0.0f);
-    glRotatef(cameraYaw, 0.0f, 1.0f, 0.0f);
-    
-    // Depois aplicar translação
-    glTranslatef(cameraX, cameraY, cameraZ);
+    setupProjection(w, h);
+    updateCamera();
 }
 
 void keyboard(unsigned char key, int x, int y) {
     float moveSpeed = cameraSpeed;
     
+    // Garantir vetores atualizados caso o mouse tenha girado a câmera desde o último quadro
+    calculateCameraVectors();
+    
     switch (key) {
         case 27: // Tecla ESC
+            stopRecording();
+            stopInput();
             exit(0);
             break;
         case 'w': // Mover para frente na direção da câmera
@@ -891,14 +852,34 @@ void keyboard(unsigned char key, int x, int y) {
         case 'L': // Alternar iluminação
         case 'l':
             lightEnabled = !lightEnabled;
+            setCapability(GL_LIGHTING, lightEnabled);
             if (lightEnabled) {
-                glEnable(GL_LIGHTING);
                 printf("Iluminação: ATIVADA\n");
             } else {
-                glDisable(GL_LIGHTING);
                 printf("Iluminação: DESATIVADA\n");
             }
             break;
+        case 'V': // Gravar os quadros em disco
+        case 'v':
+            toggleRecording();
+            break;
+        case 'H': // Mostrar o perfil de tempo dos quadros
+        case 'h':
+            toggleProfiler();
+            break;
+        case 'K': // Escrever o rastro de execução até aqui
+        case 'k':
+            if (tracingEnabled) {
+                flushTrace();
+            } else {
+                printf("Rastro desligado: use --rastro arquivo.json\n");
+            }
+            break;
+        case 'E': // Mostrar chamadas de estado do OpenGL por quadro
+        case 'e':
+            showStateStats = !showStateStats;
+            lastStateStatsTime = 0;
+            break;
         case '.': // Aumentar velocidade da simulação
             timeStep *= 1.2f;
             printf("Velocidade da simulação: %.2f\n", timeStep);
@@ -940,7 +921,7 @@ void keyboard(unsigned char key, int x, int y) {
         default:
             break;
     }
-    glutPostRedisplay();
+    requestRedraw();
 }
 
 void mouseMotion(int x, int y) {
@@ -966,6 +947,42 @@ void mouseMotion(int x, int y) {
     lastMouseY = y;
 }
 
+// Selecionar com o clique esquerdo o objeto sob o cursor e passar a segui-lo
+void mouseButton(int button, int state, int x, int y) {
+    if (button != GLUT_LEFT_BUTTON || state != GLUT_DOWN) return;
+    
+    // Raio do ponto clicado no plano próximo até o plano distante, em coordenadas do mundo
+    Mat4 inverseViewProjection;
+    if (!mat4Inverse(&viewProjectionMatrix, &inverseViewProjection)) return;
+    
+    int width = glutGet(GLUT_WINDOW_WIDTH);
+    int height = glutGet(GLUT_WINDOW_HEIGHT);
+    float ndcX = 2.0f * x / width - 1.0f;
+    float ndcY = 1.0f - 2.0f * y / height;
+    Vec3 nearPoint = mat4TransformPoint(&inverseViewProjection, vec3(ndcX, ndcY, -1.0f));
+    Vec3 farPoint = mat4TransformPoint(&inverseViewProjection, vec3(ndcX, ndcY, 1.0f));
+    Vec3 direction = vec3Normalize(vec3Sub(farPoint, nearPoint));
+    
+    // Objeto mais próximo atingido pelo raio
+    int picked = -1;
+    float pickedDistance = 0.0f;
+    for (int i = 0; i < objectCount; i++) {
+        Vec3 center = vec3(objects[i].posX, objects[i].posY, objects[i].posZ);
+        float t = raySphereIntersect(nearPoint, direction, center, objects[i].radius);
+        if (t >= 0.0f && (picked < 0 || t < pickedDistance)) {
+            picked = i;
+            pickedDistance = t;
+        }
+    }
+    
+    if (picked >= 0) {
+        cameraFollowMode = picked;
+        earthAxisView = false;
+        printf("Seguindo: %s\n", objects[picked].name);
+        requestRedraw();
+    }
+}
+
 void mouseEntry(int state) {
     if (state == GLUT_LEFT) {
         // Mouse saiu da janela, resetar rastreamento
@@ -974,135 +991,328 @@ void mouseEntry(int state) {
     }
 }
 
-// Função para renderizar texto 3D
-void renderText3D(const char* text, float x, float y, float z) {
-    // Salvar o estado atual da matriz de projeção
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    
-    // Salvar o estado atual da matriz de visualização
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    
-    // Desativar iluminação para o texto
-    glDisable(GL_LIGHTING);
-    
-    // Definir cor do texto (branco)
-    glColor3f(1.0f, 1.0f, 1.0f);
-    
-    // Posicionar o texto
-    glTranslatef(x, y, z);
-    
-    // Fazer o texto sempre olhar para a câmera (billboarding)
-    // Obter a matriz de visualização atual
-    GLfloat modelview[16];
-    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+// Renderizar as órbitas dos planetas
+void renderOrbitPaths() {
+    // Se a exibição de órbitas estiver desativada, não renderizar nada
+    if (!showOrbits) return;
     
-    // Resetar a rotação da matriz de visualização
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (i == j) {
-                modelview[i * 4 + j] = 1.0f;
-            } else {
-                modelview[i * 4 + j] = 0.0f;
+    // Regerar a geometria somente quando os elementos orbitais mudarem
+    // (apenas órbitas ao redor de corpos parados, cuja geometria não se move)
+    if (orbitPathsDirty) {
+        OrbitPath* paths = malloc(objectCount * sizeof(OrbitPath));
+        int pathCount = 0;
+        for (int i = 0; paths && i < objectCount; i++) {
+            int parent = objects[i].parent;
+            if (objects[i].orbit.semiMajorAxis > 0.0f && parent >= 0 && objects[parent].fixed
+                && objects[parent].parent < 0) {
+                paths[pathCount++] = objects[i].orbit;
             }
         }
+        buildOrbitPaths(paths, pathCount);
+        free(paths);
+        orbitPathsDirty = false;
     }
     
-    // Aplicar a matriz modificada
-    glLoadMatrixf(modelview);
-    
-    // Escalar o texto para um tamanho adequado (reduzido para 0.2)
-    glScalef(0.015f, 0.015f, 0.015f);
+    // Desabilitar texturas e iluminação para desenhar linhas
+    setCapability(GL_TEXTURE_2D, false);
+    setCapability(GL_LIGHTING, false);
     
-    // Renderizar o texto
-    for (const char* p = text; *p; p++) {
-        glutStrokeCharacter(GLUT_STROKE_MONO_ROMAN, *p);
-    }
+    // Definir largura da linha
+    glLineWidth(1.0f);
     
-    // Restaurar iluminação
-    if (lightEnabled) {
-        glEnable(GL_LIGHTING);
+    // Todas as órbitas (com suas cores por vértice) em uma única chamada.
+    // O array de cores deixa a cor atual indefinida.
+    drawOrbitPaths();
+    invalidateRenderState();
+}
+
+static int compareDrawItems(const void* a, const void* b) {
+    uint64_t keyA = ((const DrawItem*)a)->key;
+    uint64_t keyB = ((const DrawItem*)b)->key;
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+static void addDrawItem(int* count, int object, int pass, GLuint texture, bool ring) {
+    if (*count == drawQueueCapacity) {
+        int newCapacity = drawQueueCapacity ? drawQueueCapacity * 2 : 64;
+        DrawItem* newQueue = realloc(drawQueue, newCapacity * sizeof(DrawItem));
+        if (!newQueue) return;
+        drawQueue = newQueue;
+        drawQueueCapacity = newCapacity;
     }
-    
-    // Restaurar as matrizes
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    DrawItem* item = &drawQueue[(*count)++];
+    // Acima do limite o índice só deixa de desempatar: o desenho usa item->object
+    uint64_t tieBreak = object < DRAW_KEY_OBJECT_MAX ? (uint64_t)object : DRAW_KEY_OBJECT_MAX;
+    item->key = ((uint64_t)pass << DRAW_KEY_PASS_SHIFT) |
+                ((uint64_t)texture << DRAW_KEY_TEXTURE_SHIFT) | tieBreak;
+    item->object = object;
+    item->texture = texture;
+    item->ring = ring;
 }
 
-// Renderizar as órbitas dos planetas
-void renderOrbitPaths() {
-    // Se a exibição de órbitas estiver desativada, não renderizar nada
-    if (!showOrbits) return;
-    
-    // Desabilitar texturas e iluminação para desenhar linhas
-    glDisable(GL_TEXTURE_2D);
-    glDisable(GL_LIGHTING);
+// Corrigir a orientação das texturas (90 graus em X), aplicar a inclinação axial
+// e depois a rotação do objeto em torno do eixo Z, alinhado com o polo norte-sul
+static Mat4 bodyModelMatrix(const CelestialObject* obj) {
+    Quat tilt = quatFromAxisAngle(vec3(1.0f, 0.0f, 0.0f), 90.0f + obj->axialTilt);
+    Quat spin = quatFromAxisAngle(vec3(0.0f, 0.0f, 1.0f), obj->rotationAngle);
+    return mat4FromQuatTranslation(quatMultiply(tilt, spin), vec3(obj->posX, obj->posY, obj->posZ));
+}
+
+// Os anéis não giram com o planeta: inclinação axial mais 75 graus em X
+static Mat4 ringModelMatrix(const CelestialObject* obj) {
+    Quat ringTilt = quatFromAxisAngle(vec3(1.0f, 0.0f, 0.0f), obj->axialTilt + 75.0f);
+    return mat4FromQuatTranslation(ringTilt, vec3(obj->posX, obj->posY, obj->posZ));
+}
+
+// Monta a fila com os corpos visíveis, ordena por estado e desenha. As mudanças de
+// estado passam pelo cache, então itens seguidos com o mesmo estado não geram chamadas.
+// Com o desenho instanciado, todos os corpos saem em uma chamada por array de texturas.
+void drawBodies() {
+    static const float ringColor[3] = { 0.9f, 0.8f, 1.0f };
+    if (instancedSpheres) {
+        beginSphereBatch();
+    }
+    int itemCount = 0;
+    for (int i = 0; i < objectCount; i++) {
+        Vec3 position = vec3(objects[i].posX, objects[i].posY, objects[i].posZ);
+        bool hasRings = strcmp(objects[i].name, "Saturno") == 0;
+        
+        // Descartar objetos fora do campo de visão (os anéis dobram o raio de Saturno)
+        float boundingRadius = objects[i].radius * (hasRings ? 2.0f : 1.0f);
+        if (!frustumContainsSphere(&viewFrustum, position, boundingRadius)) {
+            continue;
+        }
+        
+        // Pedir o detalhe de textura que o tamanho na tela justifica
+        int texture = 0;
+        if (objects[i].texture > 0) {
+            float distance = -mat4TransformPoint(&viewMatrix, position).z;
+            float pixelDiameter = 2.0f * objects[i].radius * projectionMatrix.m[5]
+                                * 0.5f * viewportHeight / fmaxf(distance, 0.001f);
+            requestTextureDetail(objects[i].texture, pixelDiameter);
+            if (textureReady(objects[i].texture)) {
+                texture = objects[i].texture;
+            }
+        }
+        
+        if (instancedSpheres) {
+            // Camada no array de texturas (-1 desenha só com a cor)
+            GLuint array = textureObject(texture);
+            int layer = texture > 0 ? textureLayer(texture) : -1;
+            float minLod = textureMinLod(texture);
+            float color[3] = { objects[i].r, objects[i].g, objects[i].b };
+            Mat4 model = bodyModelMatrix(&objects[i]);
+            addSphereInstance(&model, objects[i].radius, color, i != 0, array, layer, minLod);
+            if (hasRings) {
+                Mat4 ringModel = ringModelMatrix(&objects[i]);
+                addRingInstance(&ringModel, objects[i].radius, ringColor, array, layer, minLod);
+            }
+        } else {
+            // O sol (primeiro objeto) é autoluminoso
+            GLuint textureName = textureObject(texture);
+            addDrawItem(&itemCount, i, i == 0 ? PASS_EMISSIVE : PASS_LIT, textureName, false);
+            if (hasRings) {
+                addDrawItem(&itemCount, i, PASS_UNLIT, textureName, true);
+            }
+        }
+        
+        // Enfileirar o nome do planeta acima dele (posição ajustada para ficar mais próximo)
+        queueLabel(objects[i].label, objects[i].posX, objects[i].posY + objects[i].radius + 0.5f, objects[i].posZ);
+    }
     
-    // Salvar cor atual
-    float currentColor[4];
-    glGetFloatv(GL_CURRENT_COLOR, currentColor);
+    // Material emissor do Sol e dos demais corpos
+    static const GLfloat sunEmission[] = { 1.0f, 0.9f, 0.2f, 1.0f };
+    static const GLfloat noEmission[] = { 0.0f, 0.0f, 0.0f, 1.0f };
     
-    // Definir largura da linha
-    glLineWidth(1.0f);
+    if (instancedSpheres) {
+        // O shader lê o material atual; o Sol não usa iluminação
+        setMaterialEmission(noEmission);
+        drawSphereBatch(&viewMatrix, &projectionMatrix, lightEnabled);
+        return;
+    }
     
-    // Cores para as órbitas de cada planeta (começando do índice 1, o Sol não tem órbita)
-    float orbitColors[9][3] = {
-        {1.0f, 1.0f, 1.0f},  // Cor não usada (Sol)
-        {0.8f, 0.8f, 0.8f},  // Mercúrio - cinza claro
-        {0.9f, 0.7f, 0.0f},  // Vênus - laranja amarelado
-        {0.0f, 0.5f, 1.0f},  // Terra - azul
-        {1.0f, 0.3f, 0.0f},  // Marte - vermelho
-        {0.9f, 0.7f, 0.5f},  // Júpiter - bege
-        {0.9f, 0.8f, 0.5f},  // Saturno - amarelado
-        {0.5f, 0.8f, 0.9f},  // Urano - azul-esverdeado
-        {0.0f, 0.0f, 0.8f}   // Netuno - azul escuro
-    };
+    qsort(drawQueue, itemCount, sizeof(DrawItem), compareDrawItems);
     
-    // Desenhar órbita para cada planeta (exceto o Sol)
-    for (int i = 1; i < objectCount; i++) {
-        float radius = orbitalRadii[i];
+    for (int k = 0; k < itemCount; k++) {
+        const CelestialObject* obj = &objects[drawQueue[k].object];
+        int pass = (int)(drawQueue[k].key >> DRAW_KEY_PASS_SHIFT);
         
-        // Definir cor da órbita
-        glColor3f(orbitColors[i][0], orbitColors[i][1], orbitColors[i][2]);
+        setCapability(GL_LIGHTING, pass == PASS_LIT && lightEnabled);
+        setMaterialEmission(pass == PASS_EMISSIVE ? sunEmission : noEmission);
         
-        // Desenhar círculo no plano XZ
-        glBegin(GL_LINE_LOOP);
-        for (int j = 0; j < 360; j += 5) {  // incremento de 5 graus para suavidade
-            float angle = j * M_PI / 180.0f;
-            float x = radius * cos(angle);
-            float z = radius * sin(angle);
-            glVertex3f(x, 0.0f, z);
+        // Usar textura se o objeto tiver uma textura pronta (os anéis usam a do planeta)
+        if (drawQueue[k].texture > 0) {
+            setCapability(GL_TEXTURE_2D, true);
+            bindTexture2D(drawQueue[k].texture);
+            setTextureEnvMode(GL_MODULATE);
+        } else {
+            setCapability(GL_TEXTURE_2D, false);
+        }
+        
+        if (!drawQueue[k].ring) {
+            // Definir cor (será usada como fator de multiplicação para a textura)
+            setColor(obj->r, obj->g, obj->b);
+            
+            Mat4 model = bodyModelMatrix(obj);
+            Mat4 modelView = mat4Multiply(&viewMatrix, &model);
+            glLoadMatrixf(modelView.m);
+            
+            gluSphere(bodyQuadric, obj->radius, 32, 32);
+        } else {
+            profileBegin(PHASE_RINGS);
+            Mat4 ringModel = ringModelMatrix(obj);
+            Mat4 ringModelView = mat4Multiply(&viewMatrix, &ringModel);
+            glLoadMatrixf(ringModelView.m);
+            
+            // Definir cor dos anéis (tom amarelado)
+            setColor(ringColor[0], ringColor[1], ringColor[2]);
+            
+            // Desenhar três anéis com diferentes raios
+            float innerRadius = obj->radius * 1.2f;
+            float outerRadius = obj->radius * 2.0f;
+            float ringThickness = 0.05f;
+            
+            // Anel médio
+            gluDisk(bodyQuadric, innerRadius + ringThickness * 2, 
+                   innerRadius + ringThickness * 3, 32, 1);
+            
+            // 5 anéis entre o médio e o externo
+            float spacing = (outerRadius - (innerRadius + ringThickness * 3)) / 6.0f;
+            for(int j = 0; j < 5; j++) {
+                float currentRadius = innerRadius + ringThickness * 3 + spacing * (j + 1);
+                gluDisk(bodyQuadric, currentRadius, currentRadius + ringThickness, 32, 1);
+            }
+            
+            // Anel externo
+            gluDisk(bodyQuadric, outerRadius - ringThickness, 
+                   outerRadius, 32, 1);
+            profileEnd(PHASE_RINGS);
         }
-        glEnd();
     }
+}
+
+// Desenha os quadros da trajetória da câmera sem janela e grava cada um em disco
+int runHeadless(void) {
+    if (!startHeadless(&headlessOptions)) return 1;
+    markStartupPhase("contexto EGL");
     
-    // Restaurar cor original
-    glColor4fv(currentColor);
+    init();
     
-    // Restaurar estados
-    if (lightEnabled) {
-        glEnable(GL_LIGHTING);
+    // Medindo a inicialização, o primeiro quadro sai como na janela: sem esperar as texturas
+    if (measureStartup) {
+        reshape(headlessOptions.width, headlessOptions.height);
+        display();
+        glFinish();
+        firstFramePresented();
+        stopHeadless(&headlessOptions);
+        return 0;
+    }
+    finishTextureLoading();
+    reshape(headlessOptions.width, headlessOptions.height);
+    if (!startRecording(headlessOptions.outputDir, headlessOptions.format,
+                        headlessOptions.width, headlessOptions.height)) {
+        stopHeadless(&headlessOptions);
+        return 1;
     }
+    
+    // display() lê cada quadro para a gravação
+    int frames = headlessFrameCount(&headlessOptions);
+    for (int frame = 0; frame < frames; frame++) {
+        if (sampleCameraPath(&headlessOptions, frame, &cameraX, &cameraY, &cameraZ,
+                             &cameraYaw, &cameraPitch)) {
+            cameraVectorsDirty = true;
+        }
+        display();
+    }
+    
+    stopRecording();
+    stopHeadless(&headlessOptions);
+    return 0;
 }
 
 int main(int argc, char** argv) {
-    glutInit(&argc, argv);
+    beginStartupTimer();
+    
+    // O GLUT tira os próprios argumentos (-display, -geometry...) antes da leitura abaixo,
+    // mas sem janela ele não pode ser iniciado
+    bool windowed = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sem-janela") == 0) windowed = false;
+    }
+    if (windowed) {
+        glutInit(&argc, argv);
+        markStartupPhase("glutInit");
+    }
+    
+    // Argumentos: [catálogo.csv] [--asteroides N] [--fps N] [--sem-vsync]
+    //             [--saida pasta] [--formato png|y4m|ppm]
+    //             [--gravar-entrada arquivo | --repetir-entrada arquivo] [--rastro arquivo.json]
+    //             [--medir-inicio] [--relatorio-memoria] [--orcamento-texturas MB]
+    //             [--sem-janela [--camera trajetoria.csv] [--quadros N] [--tamanho LxA]]
+    const char* inputRecordPath = NULL;
+    const char* inputReplayPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--asteroides") == 0 && i + 1 < argc) {
+            asteroidCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rastro") == 0 && i + 1 < argc) {
+            startTracing(argv[++i]);
+        } else if (strcmp(argv[i], "--medir-inicio") == 0 || strcmp(argv[i], "--measure-startup") == 0) {
+            measureStartup = true;
+        } else if (strcmp(argv[i], "--relatorio-memoria") == 0 || strcmp(argv[i], "--mem-report") == 0) {
+            enableMemoryReport();
+        } else if (strcmp(argv[i], "--orcamento-texturas") == 0 && i + 1 < argc) {
+            setTextureMemoryBudget((size_t)(atof(argv[++i]) * 1024.0 * 1024.0));
+        } else if (strcmp(argv[i], "--gravar-entrada") == 0 && i + 1 < argc) {
+            inputRecordPath = argv[++i];
+        } else if (strcmp(argv[i], "--repetir-entrada") == 0 && i + 1 < argc) {
+            inputReplayPath = argv[++i];
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            targetFps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sem-vsync") == 0) {
+            vsyncEnabled = false;
+        } else if (!parseHeadlessOption(argc, argv, &i, &headlessOptions)) {
+            catalogPath = argv[i];
+        }
+    }
+    
+    if (headlessOptions.enabled) {
+        if (inputRecordPath || inputReplayPath) {
+            fprintf(stderr, "A gravação e a repetição da entrada precisam de janela\n");
+            return 1;
+        }
+        return runHeadless();
+    }
+    
+    // A repetição usa o tamanho de janela da gravação e desenha o mais rápido
+    // possível, para os tempos dos quadros serem comparáveis
+    if (inputReplayPath) {
+        if (!startInputReplay(inputReplayPath, &windowWidth, &windowHeight)) return 1;
+        targetFps = 0;
+        vsyncEnabled = false;
+    }
+    
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(windowWidth, windowHeight);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Sistema Solar");
+    initFrameScheduler(targetFps, vsyncEnabled);
+    markStartupPhase("janela");
     
     init();
     
+    // Texturas carregando em segundo plano mudariam os quadros de uma execução para outra
+    if (inputReplayPath) finishTextureLoading();
+    if (inputRecordPath && !startInputRecording(inputRecordPath, windowWidth, windowHeight)) return 1;
+    
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
-    glutKeyboardFunc(keyboard);
-    glutMotionFunc(mouseMotion);
-    glutPassiveMotionFunc(mouseMotion);
-    glutEntryFunc(mouseEntry);
+    InputHandlers inputHandlers = {
+        .keyboard = keyboard,
+        .motion = mouseMotion,
+        .button = mouseButton,
+        .entry = mouseEntry
+    };
+    registerInputHandlers(&inputHandlers);
     
     glutMainLoop();
     return 0;
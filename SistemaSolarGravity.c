@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <stdbool.h> // Para o tipo bool
+#include <string.h>
 
 // Define M_PI se não estiver definido
 #ifndef M_PI
@@ -12,6 +13,16 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include "agendador.h"
+#include "compartilhado.h"
+#include "conservacao.h"
+#include "entrada.h"
+#include "gravacao.h"
+#include "headless.h"
+#include "rastro.h"
+#include "simulacao.h"
+#include "matematica.h"
+
 #ifdef GL_VERSION_1_1
 static GLuint earthTexName;
 static GLuint sunTexName;
@@ -45,26 +56,38 @@ bool mouseActive = true; // Se o movimento do mouse está ativo
 float forwardX, forwardY, forwardZ;  // Vetor para frente
 float rightX, rightY, rightZ;        // Vetor para direita
 float upX, upY, upZ;                 // Vetor para cima
+bool cameraVectorsDirty = true;      // Yaw/pitch mudaram desde o último cálculo dos vetores
+
+// Matrizes calculadas na CPU uma vez por quadro (nada é lido de volta do OpenGL)
+Mat4 projectionMatrix;
+Mat4 viewMatrix;
+Mat4 lastViewMatrix; // Visão do quadro anterior, para saber se a câmera se moveu
 
-// Definição do tipo de objeto celeste
+// Definição do tipo de objeto celeste. A gravidade fica na simulação (simulacao.h);
+// aqui ficam a aparência e a posição lida dela para o desenho.
 typedef struct {
-    double posX, posY, posZ;     // Posição
-    double velX, velY, velZ;     // Velocidade
-    double accX, accY, accZ;     // Aceleração
-    double mass;                 // Massa em kg
+    double posX, posY, posZ;     // Posição (copiada da simulação a cada passo)
     float radius;                // Raio em unidades GL
     GLuint texture;              // Textura do objeto
     float r, g, b;               // Cor do objeto (para backup se não tiver textura)
     bool fixed;                  // Se o objeto está fixo no espaço (não se move pela gravidade)
 } CelestialObject;
 
-// Array de objetos celestes
+// Array de objetos celestes; o índice é o id do corpo na simulação
 #define MAX_OBJECTS 2  // Apenas Sol e Terra
 CelestialObject objects[MAX_OBJECTS];
 int objectCount = 0;
 
+// O Sol é o primeiro objeto criado
+#define SUN_ID 0
+
+// Gravidade entre os corpos e o estado lido dela depois de cada passo
+Simulation* simulation = NULL;
+SimBodyState bodyStates[MAX_OBJECTS];
+
 // Variáveis de física
 double timeStep = 0.01;     // Fator de escala de tempo
+double simulationTime = 0.0; // Soma dos passos já simulados (conferida na repetição da entrada)
 double simulationScale = 1.0e9;  // Escala da simulação: 1 unidade GL = 1 bilhão de metros
 // Fator para amplificar a força gravitacional na simulação visual
 double gravitationalFactor = 50.0;  // 9.0 é um valor alto para tornar o efeito visível
@@ -73,6 +96,14 @@ double gravitationalFactor = 50.0;  // 9.0 é um valor alto para tornar o efeito
 int lightEnabled = 1;  // Iluminação habilitada por padrão
 bool simulationPaused = false;
 
+// Ritmo dos quadros com janela
+int targetFps = DEFAULT_TARGET_FPS; // --fps N (0 = sem limite)
+bool vsyncEnabled = true;           // --sem-vsync desliga
+
+// Modo sem janela (--sem-janela): quadros desenhados em um FBO e gravados em disco
+HeadlessOptions headlessOptions = { .width = 800, .height = 600, .outputDir = "quadros",
+                                    .format = RECORDING_PNG };
+
 // Propriedades de iluminação
 GLfloat lightAmbient[] = { 0.5f, 0.5f, 0.5f, 1.0f };  // Luz ambiente
 GLfloat lightDiffuse[] = { 1.0f, 1.0f, 0.8f, 1.0f };  // Luz difusa amarelada para o sol
@@ -88,11 +119,12 @@ void loadSunTexture();
 void setupLighting();
 void toggleFullscreen();
 void resizeWindow(int width, int height);
+void setupProjection(int width, int height);
+void updateFrameMatrices();
 void addCelestialObject(double posX, double posY, double posZ, 
                        double velX, double velY, double velZ,
                        double mass, float radius, GLuint texture,
                        float r, float g, float b, bool fixed);
-void updateGravitationalForces();
 
 // Função genérica para carregar texturas
 void loadTexture(const char* filename, GLuint* texId) {
@@ -187,22 +219,18 @@ void resizeWindow(int width, int height) {
         windowHeight = height;
     }
     
+    setupProjection(width, height);
+    updateCamera();
+}
+
+// Configurar viewport e projeção (matriz calculada na CPU)
+void setupProjection(int width, int height) {
+    if (height <= 0) height = 1;
     glViewport(0, 0, (GLsizei)width, (GLsizei)height);
+    projectionMatrix = mat4Perspective(60.0f, (float)width / (float)height, 0.1f, 1000.0f); // Aumentado o far plane
     glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(60.0, (GLfloat)width / (GLfloat)height, 0.1, 1000.0); // Aumentado o far plane
-    
-    calculateCameraVectors();
-    
+    glLoadMatrixf(projectionMatrix.m);
     glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Aplicar rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X)
-    glRotatef(cameraPitch, 1.0f, 0.0f, 0.0f);
-    glRotatef(cameraYaw, 0.0f, 1.0f, 0.0f);
-    
-    // Depois aplicar translação
-    glTranslatef(cameraX, cameraY, cameraZ);
 }
 
 // Adicionar um objeto celeste ao sistema
@@ -211,11 +239,19 @@ void addCelestialObject(double posX, double posY, double posZ,
                         double mass, float radius, GLuint texture,
                         float r, float g, float b, bool fixed) {
     if (objectCount < MAX_OBJECTS) {
+        SimBody body = {
+            .kind = fixed ? SIM_BODY_FIXED : SIM_BODY_FREE,
+            .position = { posX, posY, posZ },
+            .velocity = { velX, velY, velZ },
+            .mass = mass,
+            .parent = -1
+        };
+        if (simAddBody(simulation, &body) != objectCount) {
+            printf("Erro: Memória insuficiente para a simulação.\n");
+            return;
+        }
         CelestialObject obj = {
             .posX = posX, .posY = posY, .posZ = posZ,
-            .velX = velX, .velY = velY, .velZ = velZ,
-            .accX = 0.0, .accY = 0.0, .accZ = 0.0,
-            .mass = mass,
             .radius = radius,
             .texture = texture,
             .r = r, .g = g, .b = b,
@@ -227,77 +263,44 @@ void addCelestialObject(double posX, double posY, double posZ,
     }
 }
 
-// Atualizar forças gravitacionais entre todos os objetos
-void updateGravitationalForces() {
-    // Resetar acelerações para objetos não fixos
-    for (int i = 0; i < objectCount; i++) {
-        if (!objects[i].fixed) {
-            objects[i].accX = 0.0;
-            objects[i].accY = 0.0;
-            objects[i].accZ = 0.0;
-        }
-    }
-    
-    // Calcular forças gravitacionais entre todos os pares de objetos
-    for (int i = 0; i < objectCount; i++) {
-        if (objects[i].fixed) continue; // Objetos fixos não são afetados pela gravidade
-        
-        for (int j = 0; j < objectCount; j++) {
-            if (i == j) continue; // Pular auto-interação
-            
-            // Calcular vetor distância entre os objetos em unidades GL
-            double dx = objects[j].posX - objects[i].posX;
-            double dy = objects[j].posY - objects[i].posY;
-            double dz = objects[j].posZ - objects[i].posZ;
-            
-            // Distância ao quadrado em unidades GL
-            double distSq = dx*dx + dy*dy + dz*dz;
-            
-            // Evitar divisão por zero ou forças muito grandes quando muito próximos
-            if (distSq < 0.1) { // Usar um valor fixo pequeno para evitar explosões
-                continue;
-            }
-            
-            // Calcular a distância real
-            double dist = sqrt(distSq);
-            
-            // Abordagem simplificada: aplicar força diretamente proporcional a 1/r²
-            // Usar um valor muito maior para a constante gravitacional na simulação
-            double forceFactor = gravitationalFactor / (distSq);
-            
-            // Componentes normalizados da aceleração
-            double accX = dx / dist * forceFactor;
-            double accY = dy / dist * forceFactor;
-            double accZ = dz / dist * forceFactor;
-            
-            // Adicionar à aceleração total do objeto i
-            objects[i].accX += accX;
-            objects[i].accY += accY;
-            objects[i].accZ += accZ;
-        }
-    }
-}
-
 // Atualizar a física de todos os objetos
 void updatePhysics() {
     if (simulationPaused) return;
     
-    // Atualizar forças gravitacionais entre objetos
-    updateGravitationalForces();
+    // Reordenação, forças, grandezas conservadas (se o monitor pedir, no estado de
+    // antes da integração) e integração, cada fase marcada no rastro
+    simSetTimeStep(simulation, timeStep);
+    simSetMeasurement(simulation, conservationMonitorActive(), conservationPotentialDue());
+    if (!simStep(simulation, 1)) {
+        fprintf(stderr, "Erro: Memória insuficiente para o passo da simulação.\n");
+    }
+    simulationTime = simTime(simulation);
     
-    // Atualizar velocidades e posições usando as acelerações calculadas
-    for (int i = 0; i < objectCount; i++) {
-        if (objects[i].fixed) continue; // Objetos fixos não se movem
-        
-        // Atualizar velocidade com base na aceleração (v = v + a*t)
-        objects[i].velX += objects[i].accX * timeStep;
-        objects[i].velY += objects[i].accY * timeStep;
-        objects[i].velZ += objects[i].accZ * timeStep;
-        
-        // Atualizar posição com base na velocidade (p = p + v*t)
-        objects[i].posX += objects[i].velX * timeStep;
-        objects[i].posY += objects[i].velY * timeStep;
-        objects[i].posZ += objects[i].velZ * timeStep;
+    int count = simGetState(simulation, bodyStates, objectCount);
+    for (int i = 0; i < count; i++) {
+        objects[i].posX = bodyStates[i].position[0];
+        objects[i].posY = bodyStates[i].position[1];
+        objects[i].posZ = bodyStates[i].position[2];
+    }
+    
+    ConservationSample conservation;
+    if (conservationMonitorActive() && simLastConservation(simulation, &conservation)) {
+        submitConservationSample(&conservation);
+    }
+    
+    // Estado do fim do passo para os leitores da memória compartilhada
+    SharedBody* shared = beginSharedStateWrite();
+    if (shared) {
+        traceBegin("publicacao");
+        for (int i = 0; i < count; i++) {
+            shared[i] = (SharedBody){
+                .id = i, .fixed = bodyStates[i].kind != SIM_BODY_FREE,
+                .position = { bodyStates[i].position[0], bodyStates[i].position[1], bodyStates[i].position[2] },
+                .velocity = { bodyStates[i].velocity[0], bodyStates[i].velocity[1], bodyStates[i].velocity[2] }
+            };
+        }
+        endSharedStateWrite(count, simStepCount(simulation), simulationTime);
+        traceEnd();
     }
 }
 
@@ -309,14 +312,25 @@ void init(void) {
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     
     // Carregar as texturas
+    traceBegin("texturas");
     loadEarthTexture();
     loadSunTexture();
+    traceEnd();
     
     // Configurar iluminação
     setupLighting();
     
     // Limpar o array de objetos celestes
     objectCount = 0;
+    SimulationConfig config = simDefaultConfig();
+    config.timeStep = timeStep;
+    config.gravitationalFactor = gravitationalFactor;
+    simulation = simCreate(&config);
+    if (!simulation) {
+        fprintf(stderr, "Erro: Memória insuficiente para a simulação\n");
+        exit(1);
+    }
+    if (tracingEnabled) simSetPhaseHooks(simulation, traceBeginSpan, traceEndSpan);
     
     // === Criar apenas o Sol e a Terra para a simulação gravitacional ===
     
@@ -358,12 +372,18 @@ void init(void) {
     printf("F: Alternar tela cheia\n");
     printf(",/.: Diminuir/aumentar velocidade da simulação\n");
     printf("P: Pausar/Continuar simulação\n");
+    printf("V: Gravar quadros em disco (liga/desliga)\n");
+    printf("K: Escrever o rastro de execução (com --rastro)\n");
     printf("ESC: Sair\n");
     printf("----------------------------------\n\n");
 }
 
 // Calcular vetores de direção da câmera com base em yaw e pitch
 void calculateCameraVectors() {
+    // A trigonometria só é refeita quando yaw/pitch mudaram
+    if (!cameraVectorsDirty) return;
+    cameraVectorsDirty = false;
+    
     // Calcular o novo vetor Forward
     forwardX = -sin(cameraYaw * M_PI / 180.0f) * cos(cameraPitch * M_PI / 180.0f);
     forwardY = sin(cameraPitch * M_PI / 180.0f);
@@ -396,33 +416,54 @@ void calculateCameraVectors() {
     upZ /= lenUp;
 }
 
+// Marcar a câmera como alterada; vetores e matrizes são recalculados uma vez no próximo quadro
 void updateCamera() {
+    cameraVectorsDirty = true;
+    if (!headlessOptions.enabled) requestRedraw();
+}
+
+// Calcular a matriz de visão uma vez por quadro
+void updateFrameMatrices() {
     calculateCameraVectors();
     
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Aplicar rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X)
-    glRotatef(cameraPitch, 1.0f, 0.0f, 0.0f);
-    glRotatef(cameraYaw, 0.0f, 1.0f, 0.0f);
-    
-    // Depois aplicar translação
-    glTranslatef(cameraX, cameraY, cameraZ);
-    
-    glutPostRedisplay();
+    // Rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X), depois a translação
+    Mat4 pitch = mat4RotationX(cameraPitch);
+    Mat4 yaw = mat4RotationY(cameraYaw);
+    Mat4 rotation = mat4Multiply(&pitch, &yaw);
+    Mat4 translation = mat4Translation(cameraX, cameraY, cameraZ);
+    viewMatrix = mat4Multiply(&rotation, &translation);
 }
 
 void display(void) {
+    // Eventos gravados deste quadro; acabada a repetição, o programa termina
+    if (!beginInputFrame(simulationTime)) {
+        stopRecording();
+        stopConservationMonitor();
+        exit(0);
+    }
+    traceBegin("quadro");
+    
     // Atualizar física
+    traceBegin("fisica");
     updatePhysics();
+    traceEnd();
     
+    // Calcular as matrizes da câmera deste quadro
+    updateFrameMatrices();
+    bool cameraMoved = memcmp(&viewMatrix, &lastViewMatrix, sizeof(Mat4)) != 0;
+    lastViewMatrix = viewMatrix;
+    
+    traceBegin("desenho");
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    // Atualizar posição da luz para estar no centro do sol
+    // Atualizar posição da luz para estar no centro do sol (transformada pela visão)
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(viewMatrix.m);
     if (objectCount > 0) {
-        lightPosition[0] = objects[0].posX;
-        lightPosition[1] = objects[0].posY;
-        lightPosition[2] = objects[0].posZ;
+        const CelestialObject* sun = &objects[SUN_ID];
+        lightPosition[0] = sun->posX;
+        lightPosition[1] = sun->posY;
+        lightPosition[2] = sun->posZ;
         lightPosition[3] = 1.0f;
         glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
     }
@@ -466,8 +507,9 @@ void display(void) {
         glColor3f(obj->r, obj->g, obj->b);
         
         // Posicionar e desenhar o objeto
-        glPushMatrix();
-        glTranslatef(obj->posX, obj->posY, obj->posZ);
+        Mat4 model = mat4Translation(obj->posX, obj->posY, obj->posZ);
+        Mat4 modelView = mat4Multiply(&viewMatrix, &model);
+        glLoadMatrixf(modelView.m);
         
         // Criar uma esfera para o objeto
         GLUquadric* quadric = gluNewQuadric();
@@ -475,8 +517,6 @@ void display(void) {
         gluQuadricNormals(quadric, GLU_SMOOTH);
         gluSphere(quadric, obj->radius, 32, 32);
         gluDeleteQuadric(quadric);
-        
-        glPopMatrix();
     }
     
     glDisable(GL_TEXTURE_2D);
@@ -484,43 +524,67 @@ void display(void) {
     // Resetar emissão
     GLfloat no_emission[] = {0.0f, 0.0f, 0.0f, 1.0f};
     glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
+    traceEnd();
+    
+    // Ler o quadro para a gravação (se ativa) antes da troca de buffers
+    traceBegin("captura");
+    captureFrame();
+    traceEnd();
+    
+    // Sem janela o quadro fica no FBO e quem chamou decide o próximo
+    if (headlessOptions.enabled) {
+        traceEnd();
+        return;
+    }
     
     // Usar double buffering para animação mais suave
+    traceBegin("troca");
     glutSwapBuffers();
+    traceEnd();
+    traceEnd();
     
-    // Solicitar redesenho para animação
-    glutPostRedisplay();
+    // Próximo quadro no ritmo da taxa alvo. Pausado, com a câmera parada e sem
+    // gravar, só a entrada do usuário pede outro quadro.
+    scheduleNextFrame(!simulationPaused || cameraMoved || recordingActive() || inputReplayActive());
+}
+
+// Liga ou desliga a gravação dos quadros da janela (pasta e formato de --saida e --formato)
+void toggleRecording() {
+    if (recordingActive()) {
+        stopRecording();
+    } else {
+        startRecording(headlessOptions.outputDir, headlessOptions.format,
+                       glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
+    }
 }
 
 void reshape(int w, int h) {
+    // Os quadros gravados têm todos o tamanho do início da gravação
+    if (recordingActive()) {
+        printf("Gravação interrompida: a janela mudou de tamanho\n");
+        stopRecording();
+    }
+    
     if (!fullscreen) {
         windowWidth = w;
         windowHeight = h;
     }
     
-    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(60.0, (GLfloat)w / (GLfloat)h, 0.1, 1000.0);
-    
-    calculateCameraVectors();
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Aplicar rotações primeiro (yaw em torno do eixo Y, pitch em torno do eixo X)
-    glRotatef(cameraPitch, 1.0f, 0.0f, 0.0f);
-    glRotatef(cameraYaw, 0.0f, 1.0f, 0.0f);
-    
-    // Depois aplicar translação
-    glTranslatef(cameraX, cameraY, cameraZ);
+    setupProjection(w, h);
+    updateCamera();
 }
 
 void keyboard(unsigned char key, int x, int y) {
     float moveSpeed = cameraSpeed;
     
+    // Garantir vetores atualizados caso o mouse tenha girado a câmera desde o último quadro
+    calculateCameraVectors();
+    
     switch (key) {
         case 27: // Tecla ESC
+            stopRecording();
+            stopInput();
+            stopConservationMonitor();
             exit(0);
             break;
         case 'w': // Mover para frente na direção da câmera
@@ -590,6 +654,18 @@ void keyboard(unsigned char key, int x, int y) {
                 printf("Iluminação: DESATIVADA\n");
             }
             break;
+        case 'K': // Escrever o rastro de execução até aqui
+        case 'k':
+            if (tracingEnabled) {
+                flushTrace();
+            } else {
+                printf("Rastro desligado: use --rastro arquivo.json\n");
+            }
+            break;
+        case 'V': // Gravar os quadros em disco
+        case 'v':
+            toggleRecording();
+            break;
         case '.': // Aumentar velocidade da simulação
             timeStep *= 1.2;
             printf("Velocidade da simulação: %.5f\n", timeStep);
@@ -602,6 +678,7 @@ void keyboard(unsigned char key, int x, int y) {
         default:
             break;
     }
+    requestRedraw();
 }
 
 void mouseMotion(int x, int y) {
@@ -635,20 +712,120 @@ void mouseEntry(int state) {
     }
 }
 
+// Desenha os quadros da trajetória da câmera sem janela e grava cada um em disco
+int runHeadless(void) {
+    if (!startHeadless(&headlessOptions)) return 1;
+    
+    init();
+    reshape(headlessOptions.width, headlessOptions.height);
+    if (!startRecording(headlessOptions.outputDir, headlessOptions.format,
+                        headlessOptions.width, headlessOptions.height)) {
+        stopHeadless(&headlessOptions);
+        return 1;
+    }
+    
+    // display() lê cada quadro para a gravação
+    int frames = headlessFrameCount(&headlessOptions);
+    for (int frame = 0; frame < frames; frame++) {
+        if (sampleCameraPath(&headlessOptions, frame, &cameraX, &cameraY, &cameraZ,
+                             &cameraYaw, &cameraPitch)) {
+            cameraVectorsDirty = true;
+        }
+        display();
+    }
+    
+    stopRecording();
+    stopConservationMonitor();
+    stopHeadless(&headlessOptions);
+    return 0;
+}
+
 int main(int argc, char** argv) {
-    glutInit(&argc, argv);
+    // O GLUT tira os próprios argumentos (-display, -geometry...) antes da leitura abaixo,
+    // mas sem janela ele não pode ser iniciado
+    bool windowed = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sem-janela") == 0) windowed = false;
+    }
+    if (windowed) {
+        glutInit(&argc, argv);
+    }
+    
+    // Argumentos: [--fps N] [--sem-vsync] [--saida pasta] [--formato png|y4m|ppm]
+    //             [--gravar-entrada arquivo | --repetir-entrada arquivo] [--rastro arquivo.json]
+    //             [--metricas arquivo.jsonl [--cadencia-potencial N] [--alarme-deriva X]]
+    //             [--sem-janela [--camera trajetoria.csv] [--quadros N] [--tamanho LxA]]
+    //             [--memoria-compartilhada /nome]
+    const char* inputRecordPath = NULL;
+    const char* inputReplayPath = NULL;
+    const char* metricsPath = NULL;
+    const char* sharedStateName = NULL;
+    int potentialCadence = DEFAULT_POTENTIAL_CADENCE;
+    double driftAlarm = DEFAULT_DRIFT_ALARM;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (strcmp(argv[i], "--rastro") == 0 && i + 1 < argc) {
+            startTracing(argv[++i]);
+        } else if (strcmp(argv[i], "--cadencia-potencial") == 0 && i + 1 < argc) {
+            potentialCadence = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--alarme-deriva") == 0 && i + 1 < argc) {
+            driftAlarm = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--gravar-entrada") == 0 && i + 1 < argc) {
+            inputRecordPath = argv[++i];
+        } else if (strcmp(argv[i], "--repetir-entrada") == 0 && i + 1 < argc) {
+            inputReplayPath = argv[++i];
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            targetFps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sem-vsync") == 0) {
+            vsyncEnabled = false;
+        } else if (strcmp(argv[i], "--memoria-compartilhada") == 0 && i + 1 < argc) {
+            sharedStateName = argv[++i];
+        } else if (!parseHeadlessOption(argc, argv, &i, &headlessOptions)) {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+        }
+    }
+    
+    if (metricsPath && !startConservationMonitor(metricsPath, potentialCadence, driftAlarm)) {
+        return 1;
+    }
+    // O segmento comporta o máximo de corpos, que não muda durante a execução
+    if (sharedStateName && !startSharedState(sharedStateName, MAX_OBJECTS)) {
+        return 1;
+    }
+    
+    if (headlessOptions.enabled) {
+        if (inputRecordPath || inputReplayPath) {
+            fprintf(stderr, "A gravação e a repetição da entrada precisam de janela\n");
+            return 1;
+        }
+        return runHeadless();
+    }
+    
+    // A repetição usa o tamanho de janela da gravação e desenha o mais rápido
+    // possível, para os tempos dos quadros serem comparáveis
+    if (inputReplayPath) {
+        if (!startInputReplay(inputReplayPath, &windowWidth, &windowHeight)) return 1;
+        targetFps = 0;
+        vsyncEnabled = false;
+    }
+    
     // Usar double buffering para animação mais suave
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(windowWidth, windowHeight);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Sistema Solar Gravitacional");
+    initFrameScheduler(targetFps, vsyncEnabled);
     init();
+    if (inputRecordPath && !startInputRecording(inputRecordPath, windowWidth, windowHeight)) return 1;
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
-    glutKeyboardFunc(keyboard);
-    glutMotionFunc(mouseMotion);
-    glutPassiveMotionFunc(mouseMotion);
-    glutEntryFunc(mouseEntry);
+    InputHandlers inputHandlers = {
+        .keyboard = keyboard,
+        .motion = mouseMotion,
+        .entry = mouseEntry
+    };
+    registerInputHandlers(&inputHandlers);
     glutMainLoop();
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "agendador.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <GL/glut.h>
+#include <GL/glx.h>
+
+// Com vsync a troca de buffers já espera o retraço vertical: o quadro começa um
+// pouco antes do prazo para não perder o retraço logo depois dele
+#define VSYNC_SLACK_MS 1.0
+
+static double framePeriodMs = 0.0; // 0 = sem limite
+static bool vsyncActive = false;
+static double nextDeadline = 0.0;   // Quando o próximo quadro deve começar
+static bool framePending = false;   // Já existe um quadro marcado
+static int scheduledFrame = 0;      // Só o timer mais recente vale; os antigos são ignorados
+
+static double nowMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+// Intervalo de troca de buffers pela extensão GLX disponível
+static bool setSwapInterval(int interval) {
+    Display* display = glXGetCurrentDisplay();
+    GLXDrawable drawable = glXGetCurrentDrawable();
+    if (!display || !drawable) return false;
+    const char* extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+    if (!extensions) return false;
+
+    if (strstr(extensions, "GLX_EXT_swap_control")) {
+        PFNGLXSWAPINTERVALEXTPROC swapIntervalEXT =
+            (PFNGLXSWAPINTERVALEXTPROC)glXGetProcAddress((const GLubyte*)"glXSwapIntervalEXT");
+        if (swapIntervalEXT) {
+            swapIntervalEXT(display, drawable, interval);
+            return true;
+        }
+    }
+    if (strstr(extensions, "GLX_MESA_swap_control")) {
+        PFNGLXSWAPINTERVALMESAPROC swapIntervalMESA =
+            (PFNGLXSWAPINTERVALMESAPROC)glXGetProcAddress((const GLubyte*)"glXSwapIntervalMESA");
+        if (swapIntervalMESA) return swapIntervalMESA((unsigned int)interval) == 0;
+    }
+    // A extensão SGI não aceita desligar
+    if (interval > 0 && strstr(extensions, "GLX_SGI_swap_control")) {
+        PFNGLXSWAPINTERVALSGIPROC swapIntervalSGI =
+            (PFNGLXSWAPINTERVALSGIPROC)glXGetProcAddress((const GLubyte*)"glXSwapIntervalSGI");
+        if (swapIntervalSGI) return swapIntervalSGI(interval) == 0;
+    }
+    return false;
+}
+
+void initFrameScheduler(int targetFps, bool vsync) {
+    framePeriodMs = targetFps > 0 ? 1000.0 / targetFps : 0.0;
+    bool changed = setSwapInterval(vsync ? 1 : 0);
+    vsyncActive = vsync && changed;
+    nextDeadline = nowMs();
+
+    if (targetFps > 0) {
+        printf("Taxa de quadros: até %d por segundo", targetFps);
+    } else {
+        printf("Taxa de quadros: sem limite");
+    }
+    printf(", vsync %s\n", changed ? (vsync ? "ATIVADO" : "DESATIVADO") : "padrão do driver");
+}
+
+static void frameTimer(int frame) {
+    if (frame == scheduledFrame) {
+        glutPostRedisplay();
+    }
+}
+
+// Marca um quadro para o prazo: já atrasado, redesenha assim que o GLUT puder;
+// senão o GLUT dorme até o timer (com resolução de 1 ms)
+static void postFrameAt(double deadline) {
+    framePending = true;
+    double wait = deadline - nowMs();
+    if (vsyncActive) wait -= VSYNC_SLACK_MS;
+    if (wait < 1.0) {
+        glutPostRedisplay();
+    } else {
+        glutTimerFunc((unsigned int)wait, frameTimer, ++scheduledFrame);
+    }
+}
+
+void scheduleNextFrame(bool animating) {
+    framePending = false;
+    scheduledFrame++; // Cancela timers de quadros que já saíram por outro pedido
+
+    // Um período depois do prazo anterior. Muito atrasado (quadro lento ou volta do
+    // repouso), recomeça a contagem agora em vez de desenhar vários quadros seguidos.
+    double now = nowMs();
+    nextDeadline += framePeriodMs;
+    if (nextDeadline < now - framePeriodMs) nextDeadline = now;
+
+    if (animating) {
+        postFrameAt(nextDeadline);
+    }
+}
+
+void requestRedraw(void) {
+    // O quadro já marcado vai mostrar a mudança; sem isso, o mouse (centenas de
+    // eventos por segundo) passaria da taxa alvo
+    if (!framePending) {
+        postFrameAt(nextDeadline);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include <stdbool.h>
+
+// Ritmo dos quadros com janela: em vez de pedir um redesenho logo ao fim de cada
+// quadro (e ocupar um núcleo inteiro), o próximo quadro é marcado para o próximo
+// prazo da taxa alvo e o GLUT dorme até lá, ainda atendendo teclado e mouse.
+// Quando nada está animando, nenhum quadro é agendado: só a entrada do usuário
+// (que chama requestRedraw) faz a cena ser redesenhada.
+
+#define DEFAULT_TARGET_FPS 60
+
+// Define a taxa alvo (0 = sem limite) e liga ou desliga o vsync. Chamar depois de
+// criar a janela.
+void initFrameScheduler(int targetFps, bool vsync);
+
+// Chamar ao fim de cada quadro, depois de trocar os buffers. Se animating for falso
+// o próximo quadro só vem com um pedido de redesenho de fora.
+void scheduleNextFrame(bool animating);
+
+// Pede um redesenho por causa da entrada do usuário, no próximo prazo (no lugar de
+// glutPostRedisplay, que desenharia a cada evento do mouse)
+void requestRedraw(void);
+
+#endif
@@ -0,0 +1,158 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_MIN_BLOCK (64 * 1024)
+#define CACHE_LINE_SIZE 64
+
+struct ArenaBlock {
+    ArenaBlock* previous;
+    size_t size;
+    size_t used;
+    _Alignas(ARENA_ALIGNMENT) unsigned char data[];
+};
+
+// Uma arena por linha de cache, para as threads não disputarem a mesma linha (o
+// vetor precisa vir de aligned_alloc: malloc só garante 16 bytes)
+struct ThreadArena {
+    _Alignas(CACHE_LINE_SIZE) Arena arena;
+};
+
+// Estatísticas do programa inteiro (as arenas em si são de cada simulação)
+static atomic_long heapAllocations;
+static atomic_size_t reservedBytes;
+
+static ArenaBlock* newBlock(size_t size, ArenaBlock* previous) {
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + size);
+    if (!block) return NULL;
+    block->previous = previous;
+    block->size = size;
+    block->used = 0;
+    atomic_fetch_add(&heapAllocations, 1);
+    atomic_fetch_add(&reservedBytes, size);
+    return block;
+}
+
+static void freeBlocks(ArenaBlock* block) {
+    while (block) {
+        ArenaBlock* previous = block->previous;
+        atomic_fetch_sub(&reservedBytes, block->size);
+        free(block);
+        block = previous;
+    }
+}
+
+void arenaFree(Arena* arena) {
+    freeBlocks(arena->current);
+    *arena = (Arena){ 0 };
+}
+
+void* arenaAlloc(Arena* arena, size_t bytes) {
+    if (!arena) return NULL;
+    bytes = (bytes + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    ArenaBlock* block = arena->current;
+    if (!block || block->size - block->used < bytes) {
+        // Bloco novo pelo menos o dobro do anterior, para poucos blocos por passo
+        size_t size = block ? block->size * 2 : ARENA_MIN_BLOCK;
+        if (size < bytes) size = bytes;
+        block = newBlock(size, block);
+        if (!block) return NULL;
+        arena->current = block;
+    }
+    void* memory = block->data + block->used;
+    block->used += bytes;
+    arena->used += bytes;
+    return memory;
+}
+
+void arenaReset(Arena* arena) {
+    if (arena->used > arena->highWater) arena->highWater = arena->used;
+    arena->used = 0;
+
+    ArenaBlock* block = arena->current;
+    if (!block) return;
+    if (block->previous) {
+        // O passo não coube em um bloco: troca todos por um que caiba o maior passo,
+        // arredondado para potência de 2 para um passo pouco maior ainda caber
+        size_t size = ARENA_MIN_BLOCK;
+        while (size < arena->highWater) size *= 2;
+        freeBlocks(block);
+        arena->current = newBlock(size, NULL);
+        return;
+    }
+    block->used = 0;
+}
+
+int arenaThreadIndex(void) {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+int arenaThreadCount(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+void beginStepArenas(StepArenas* arenas) {
+    arenaReset(&arenas->main);
+
+    // Mais threads que no passo anterior (omp_set_num_threads): arenas novas zeradas
+    int threads = arenaThreadCount();
+    if (threads > arenas->threadCount) {
+        // Sem realloc, que perderia o alinhamento: vetor novo e cópia das arenas
+        ThreadArena* grown = aligned_alloc(CACHE_LINE_SIZE, (size_t)threads * sizeof(ThreadArena));
+        if (grown) {
+            atomic_fetch_add(&heapAllocations, 1);
+            if (arenas->threadCount > 0) {
+                memcpy(grown, arenas->threads, (size_t)arenas->threadCount * sizeof(ThreadArena));
+            }
+            for (int t = arenas->threadCount; t < threads; t++) {
+                grown[t] = (ThreadArena){ 0 };
+            }
+            free(arenas->threads);
+            arenas->threads = grown;
+            arenas->threadCount = threads;
+        }
+    }
+    for (int t = 0; t < arenas->threadCount; t++) {
+        arenaReset(&arenas->threads[t].arena);
+    }
+}
+
+Arena* stepArena(StepArenas* arenas) {
+    return &arenas->main;
+}
+
+Arena* threadArena(StepArenas* arenas) {
+    int thread = arenaThreadIndex();
+    return thread < arenas->threadCount ? &arenas->threads[thread].arena : NULL;
+}
+
+void freeStepArenas(StepArenas* arenas) {
+    arenaFree(&arenas->main);
+    for (int t = 0; t < arenas->threadCount; t++) {
+        arenaFree(&arenas->threads[t].arena);
+    }
+    free(arenas->threads);
+    *arenas = (StepArenas){ 0 };
+}
+
+long arenaHeapAllocations(void) {
+    return atomic_load(&heapAllocations);
+}
+
+size_t arenaReservedBytes(void) {
+    return atomic_load(&reservedBytes);
+}
@@ -0,0 +1,67 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Alocador de dados temporários de um passo da simulação: cada alocação só avança
+// um ponteiro, e tudo é liberado de uma vez no início do passo seguinte. Quando
+// um passo precisa de mais do que o bloco atual, outro bloco é pego do heap; no
+// reinício os blocos viram um só, onde cabe o maior passo até ali com folga. Assim,
+// com o tamanho dos dados estável, os passos seguintes não chamam malloc nem free.
+//
+// Fases paralelas usam a arena da própria thread (threadArena), sem trava. Cada
+// simulação tem o próprio conjunto (StepArenas), então simulações em threads
+// diferentes não compartilham nada.
+
+typedef struct ArenaBlock ArenaBlock;
+typedef struct ThreadArena ThreadArena;
+
+typedef struct {
+    ArenaBlock* current;    // Bloco em uso (os anteriores do passo ficam encadeados)
+    size_t used;            // Bytes pedidos desde o último reinício
+    size_t highWater;       // Maior used de um passo
+} Arena;
+
+// Memória alinhada a 16 bytes, válida até o próximo arenaReset (NULL sem memória)
+void* arenaAlloc(Arena* arena, size_t bytes);
+
+// Libera tudo o que foi alocado, mantendo um bloco que caiba o maior passo
+void arenaReset(Arena* arena);
+
+// Devolve todos os blocos ao heap
+void arenaFree(Arena* arena);
+
+// Arenas de um passo: a da thread que conduz o passo e uma por thread das regiões
+// paralelas. Zerado é um conjunto vazio.
+typedef struct {
+    Arena main;
+    ThreadArena* threads;
+    int threadCount;
+} StepArenas;
+
+// Fronteira de passo: reinicia a arena do passo e as de todas as threads. Chamar
+// fora de regiões paralelas.
+void beginStepArenas(StepArenas* arenas);
+
+// Arena do passo, para a thread que conduz o passo
+Arena* stepArena(StepArenas* arenas);
+
+// Arena da thread atual dentro de uma região paralela do OpenMP (NULL, e
+// arenaAlloc falha, se a região tiver mais threads que o último beginStepArenas)
+Arena* threadArena(StepArenas* arenas);
+
+// Libera todas as arenas do conjunto (que volta a ficar vazio)
+void freeStepArenas(StepArenas* arenas);
+
+// Índice da thread atual e número máximo de threads (1 sem OpenMP)
+int arenaThreadIndex(void);
+int arenaThreadCount(void);
+
+// Quantas vezes as arenas (de todas as simulações) pediram memória ao heap desde o
+// início do programa
+long arenaHeapAllocations(void);
+
+// Bytes em blocos reservados por todas as arenas do programa
+size_t arenaReservedBytes(void);
+
+#endif
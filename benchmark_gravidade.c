@@ -0,0 +1,272 @@
+// Benchmark do núcleo da gravidade: mede updateGravitationalForces(), simStep()
+// e reorderBodies() da libsistemasolar (simulacao.c) para vários números de corpos e de
+// threads e escreve os resultados em JSON (um objeto por medição), para comparar
+// compiladores e máquinas.
+//
+// Uso: ./benchmark_gravidade [--tamanhos 2,10,...] [--threads 1,2,...]
+//                            [--tempo SEGUNDOS] [--limite SEGUNDOS] [--saida arquivo.json]
+//
+// O núcleo é incluído inteiro para medir também as fases internas do passo (as
+// forças e a reordenação sozinhas), sem OpenGL: nada aqui cria janela ou contexto.
+
+#include <stdio.h>
+#include <omp.h>
+#include <time.h>
+
+#include "simulacao.c"
+
+#define MAX_OBJECTS 1000000
+
+#define MAX_SIZES 32
+#define MAX_THREAD_COUNTS 16
+
+// Operações de ponto flutuante por interação no laço de updateGravitationalForces:
+// 3 subtrações, 3 multiplicações e 2 somas da distância, raiz, divisão da força,
+// 3 divisões e 3 multiplicações da direção e 3 somas na aceleração (raiz e
+// divisão contadas como uma operação cada)
+#define FLOPS_PER_INTERACTION 20
+
+// Cada medição repete o passo até somar este tempo (e pelo menos MIN_REPETITIONS vezes)
+#define DEFAULT_MEASURE_SECONDS 0.5
+#define MIN_REPETITIONS 3
+// Passos de aquecimento no máximo, até um passo não pedir memória ao heap
+#define MAX_WARMUP_STEPS 16
+// Tamanhos cujo passo estimado passa disto são pulados (o O(N²) com 10^6 corpos
+// levaria minutos por passo)
+#define DEFAULT_STEP_LIMIT_SECONDS 10.0
+
+static const int defaultSizes[] = { 2, 10, 100, 1000, 10000, 100000, 1000000 };
+
+typedef struct {
+    const char* name;
+    bool (*step)(Simulation* sim); // false sem memória para o passo
+    bool pairwise; // O(N²) nas interações; senão o custo cresce com o número de corpos
+} BenchmarkKernel;
+
+// Só as forças, com a fronteira de passo que simStep() faria
+static bool forcesStep(Simulation* sim) {
+    beginStepArenas(&sim->arenas);
+    return updateGravitationalForces(sim);
+}
+
+// O passo inteiro: reordenação (a cada 64 passos), forças e integração
+static bool physicsStep(Simulation* sim) {
+    return simStep(sim, 1);
+}
+
+// Só a reordenação. Depois do aquecimento os corpos já estão na ordem da chave,
+// como na simulação, em que eles pouco se movem entre duas reordenações.
+static bool reorderStep(Simulation* sim) {
+    beginStepArenas(&sim->arenas);
+    reorderBodies(sim); // Sem memória só mantém a ordem atual
+    return true;
+}
+
+static const BenchmarkKernel kernels[] = {
+    { "updateGravitationalForces", forcesStep, true },
+    { "simStep", physicsStep, true },
+    { "reorderBodies", reorderStep, false },
+};
+
+static double nowSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1.0e9;
+}
+
+// Lista de inteiros separados por vírgula
+static int parseIntList(const char* text, int* values, int maxCount) {
+    int count = 0;
+    while (*text && count < maxCount) {
+        char* end;
+        long value = strtol(text, &end, 10);
+        if (end == text) break;
+        if (value > 0) values[count++] = (int)value;
+        text = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+// Corpos espalhados num cubo com espaçamento médio de ~4 unidades (quase nenhum
+// par fica abaixo da distância mínima de updateGravitationalForces), sempre com a
+// mesma semente para que as medições sejam comparáveis (NULL sem memória)
+static Simulation* setupBodies(int count) {
+    Simulation* sim = simCreate(NULL);
+    if (!sim) return NULL;
+    srand(12345);
+    double side = 4.0 * cbrt((double)count);
+    for (int i = 0; i < count; i++) {
+        SimBody body = { .kind = SIM_BODY_FREE, .mass = 1.0e24, .parent = -1 };
+        body.position[0] = ((double)rand() / RAND_MAX - 0.5) * side;
+        body.position[1] = ((double)rand() / RAND_MAX - 0.5) * side;
+        body.position[2] = ((double)rand() / RAND_MAX - 0.5) * side;
+        if (simAddBody(sim, &body) < 0) {
+            simDestroy(sim);
+            return NULL;
+        }
+    }
+    return sim;
+}
+
+// Aquecimento: páginas do vetor, threads do OpenMP e arenas do passo (que só chegam
+// ao tamanho final no reinício depois do primeiro passo). O primeiro par próximo
+// pode aparecer só no meio da medição (com o simStep os corpos se movem), então o
+// bloco dos pares de cada thread é reservado antes. Retorna false sem memória.
+static bool warmUp(const BenchmarkKernel* kernel, Simulation* sim) {
+    beginStepArenas(&sim->arenas);
+    #pragma omp parallel
+    arenaAlloc(threadArena(&sim->arenas), sizeof(PairChunk));
+
+    for (int s = 0; s < MAX_WARMUP_STEPS; s++) {
+        long before = arenaHeapAllocations();
+        if (!kernel->step(sim)) return false;
+        if (s > 0 && arenaHeapAllocations() == before) break;
+    }
+    return true;
+}
+
+// Mediana dos tempos de cada repetição
+static int compareDoubles(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+int main(int argc, char** argv) {
+    int sizes[MAX_SIZES];
+    int sizeCount = (int)(sizeof(defaultSizes) / sizeof(defaultSizes[0]));
+    memcpy(sizes, defaultSizes, sizeof(defaultSizes));
+    int threadCounts[MAX_THREAD_COUNTS] = { 1, omp_get_max_threads() };
+    int threadCountCount = threadCounts[1] > 1 ? 2 : 1;
+    double measureSeconds = DEFAULT_MEASURE_SECONDS;
+    double stepLimit = DEFAULT_STEP_LIMIT_SECONDS;
+    const char* outputPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tamanhos") == 0 && i + 1 < argc) {
+            sizeCount = parseIntList(argv[++i], sizes, MAX_SIZES);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCountCount = parseIntList(argv[++i], threadCounts, MAX_THREAD_COUNTS);
+        } else if (strcmp(argv[i], "--tempo") == 0 && i + 1 < argc) {
+            measureSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--limite") == 0 && i + 1 < argc) {
+            stepLimit = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    FILE* output = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "Falha ao criar %s\n", outputPath);
+        return 1;
+    }
+
+    fprintf(output, "{\n  \"compilador\": \"%s\",\n  \"otimizado\": %s,\n",
+            __VERSION__,
+#ifdef __OPTIMIZE__
+            "true"
+#else
+            "false"
+#endif
+            );
+    fprintf(output, "  \"threads_disponiveis\": %d,\n  \"flops_por_interacao\": %d,\n",
+            omp_get_num_procs(), FLOPS_PER_INTERACTION);
+    fprintf(output, "  \"resultados\": [");
+
+    bool first = true;
+    for (int k = 0; k < (int)(sizeof(kernels) / sizeof(kernels[0])); k++) {
+        for (int t = 0; t < threadCountCount; t++) {
+            omp_set_num_threads(threadCounts[t]);
+            double secondsPerUnit = 0.0; // Do tamanho anterior, para estimar o próximo
+
+            for (int s = 0; s < sizeCount; s++) {
+                int count = sizes[s] < MAX_OBJECTS ? sizes[s] : MAX_OBJECTS;
+                double interactions = (double)count * (count - 1);
+                double work = kernels[k].pairwise ? interactions : count;
+                bool skipped = secondsPerUnit * work > stepLimit;
+
+                fprintf(output, "%s\n    {\"funcao\": \"%s\", \"solver\": \"direto\", \"precisao\": \"double\", "
+                        "\"threads\": %d, \"corpos\": %d", first ? "" : ",", kernels[k].name,
+                        threadCounts[t], count);
+                first = false;
+                if (skipped) {
+                    fprintf(output, ", \"pulado\": true}");
+                    fprintf(stderr, "%s, %d threads, %d corpos: pulado (passo estimado em %.0f s)\n",
+                            kernels[k].name, threadCounts[t], count, secondsPerUnit * work);
+                    continue;
+                }
+
+                Simulation* sim = setupBodies(count);
+                if (!sim) {
+                    fprintf(stderr, "Memória insuficiente para %d corpos\n", count);
+                    return 1;
+                }
+                if (!warmUp(&kernels[k], sim)) {
+                    fprintf(stderr, "Memória insuficiente para o passo com %d corpos\n", count);
+                    simDestroy(sim);
+                    return 1;
+                }
+                long allocationsBefore = arenaHeapAllocations();
+
+                // Repete até o tempo da medição, guardando cada passo
+                int capacity = 64, repetitions = 0;
+                double* times = malloc((size_t)capacity * sizeof(double));
+                if (!times) {
+                    fprintf(stderr, "Memória insuficiente para os tempos da medição\n");
+                    simDestroy(sim);
+                    return 1;
+                }
+                double start = nowSeconds(), elapsed = 0.0;
+                while (repetitions < MIN_REPETITIONS || elapsed < measureSeconds) {
+                    double stepStart = nowSeconds();
+                    bool stepped = kernels[k].step(sim);
+                    double stepEnd = nowSeconds();
+                    if (!stepped) {
+                        fprintf(stderr, "Memória insuficiente para o passo com %d corpos\n", count);
+                        free(times);
+                        simDestroy(sim);
+                        return 1;
+                    }
+                    if (repetitions == capacity) {
+                        capacity *= 2;
+                        double* grown = realloc(times, (size_t)capacity * sizeof(double));
+                        if (!grown) {
+                            fprintf(stderr, "Memória insuficiente para os tempos da medição\n");
+                            free(times);
+                            simDestroy(sim);
+                            return 1;
+                        }
+                        times = grown;
+                    }
+                    times[repetitions++] = stepEnd - stepStart;
+                    elapsed = stepEnd - start;
+                }
+                long allocations = arenaHeapAllocations() - allocationsBefore;
+                size_t arenaBytes = arenaReservedBytes();
+                simDestroy(sim);
+                qsort(times, (size_t)repetitions, sizeof(double), compareDoubles);
+                double median = times[repetitions / 2];
+                double best = times[0];
+                free(times);
+
+                secondsPerUnit = median / work;
+                fprintf(output, ", \"repeticoes\": %d, \"segundos_por_passo\": %.9g, \"melhor_passo\": %.9g, "
+                        "\"ns_por_corpo_passo\": %.6g", repetitions, median, best, median * 1.0e9 / count);
+                if (kernels[k].pairwise) {
+                    fprintf(output, ", \"interacoes_por_segundo\": %.6g, \"gflops\": %.6g",
+                            interactions / median, interactions * FLOPS_PER_INTERACTION / median / 1.0e9);
+                }
+                fprintf(output, ", \"alocacoes_heap_por_passo\": %.6g, \"arena_bytes\": %zu}",
+                        (double)allocations / repetitions, arenaBytes);
+                fprintf(stderr, "%s, %d threads, %d corpos: %.3g s por passo\n",
+                        kernels[k].name, threadCounts[t], count, median);
+            }
+        }
+    }
+    fprintf(output, "\n  ]\n}\n");
+    if (outputPath) fclose(output);
+    return 0;
+}
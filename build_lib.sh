@@ -0,0 +1,10 @@
+#!/bin/bash
+# libsistemasolar: núcleo da simulação sem OpenGL (simulacao.h), ligado pelos dois
+# programas. CFLAGS troca as opções de compilação (padrão -O2).
+FONTES="simulacao.c arena.c ordenacao.c"
+OBJETOS=""
+for fonte in $FONTES; do
+    gcc ${CFLAGS:--O2} -fopenmp -c $fonte -o ${fonte%.c}.o || exit 1
+    OBJETOS="$OBJETOS ${fonte%.c}.o"
+done
+ar rcs libsistemasolar.a $OBJETOS && rm -f $OBJETOS
@@ -0,0 +1,316 @@
+#include "catalogo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "memoria.h"
+
+#define CATALOG_FIELD_COUNT 20
+#define CATALOG_CHUNK_SIZE (256 * 1024)
+
+// Tabela hash (endereçamento aberto) de nome para índice, para resolver os pais
+typedef struct {
+    uint32_t* slots;                   // Índice + 1 de cada nome (0 = vazio)
+    uint32_t capacity;                 // Sempre potência de 2
+    char (*names)[CATALOG_NAME_LENGTH];
+    int count;
+    int namesCapacity;
+} NameTable;
+
+static uint32_t hashName(const char* s) {
+    uint32_t h = 2166136261u; // FNV-1a
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int findName(const NameTable* table, const char* name) {
+    if (table->capacity == 0) return -1;
+    uint32_t mask = table->capacity - 1;
+    for (uint32_t i = hashName(name) & mask; table->slots[i] != 0; i = (i + 1) & mask) {
+        int index = (int)table->slots[i] - 1;
+        if (strcmp(table->names[index], name) == 0) return index;
+    }
+    return -1;
+}
+
+static int growNameTable(NameTable* table) {
+    uint32_t newCapacity = table->capacity ? table->capacity * 2 : 1024;
+    uint32_t* newSlots = calloc(newCapacity, sizeof(uint32_t));
+    if (!newSlots) return 0;
+    for (int index = 0; index < table->count; index++) {
+        uint32_t i = hashName(table->names[index]) & (newCapacity - 1);
+        while (newSlots[i] != 0) i = (i + 1) & (newCapacity - 1);
+        newSlots[i] = (uint32_t)index + 1;
+    }
+    free(table->slots);
+    trackMemory(MEMORY_INDEXES, (long long)(newCapacity - table->capacity) * sizeof(uint32_t));
+    table->slots = newSlots;
+    table->capacity = newCapacity;
+    return 1;
+}
+
+// Registra o nome com o próximo índice (nomes repetidos também contam como corpos)
+static int addName(NameTable* table, const char* name) {
+    if ((uint32_t)(table->count + 1) * 2 > table->capacity && !growNameTable(table)) return 0;
+    if (table->count == table->namesCapacity) {
+        int newCapacity = table->namesCapacity ? table->namesCapacity * 2 : 1024;
+        void* newNames = realloc(table->names, (size_t)newCapacity * CATALOG_NAME_LENGTH);
+        if (!newNames) return 0;
+        trackMemory(MEMORY_INDEXES, (long long)(newCapacity - table->namesCapacity) * CATALOG_NAME_LENGTH);
+        table->names = newNames;
+        table->namesCapacity = newCapacity;
+    }
+    strcpy(table->names[table->count], name);
+
+    uint32_t mask = table->capacity - 1;
+    uint32_t i = hashName(name) & mask;
+    while (table->slots[i] != 0) {
+        if (strcmp(table->names[table->slots[i] - 1], name) == 0) break; // Mantém o primeiro
+        i = (i + 1) & mask;
+    }
+    if (table->slots[i] == 0) table->slots[i] = (uint32_t)table->count + 1;
+    table->count++;
+    return 1;
+}
+
+static void freeNameTable(NameTable* table) {
+    trackMemory(MEMORY_INDEXES, -(long long)table->capacity * (long long)sizeof(uint32_t)
+                                - (long long)table->namesCapacity * CATALOG_NAME_LENGTH);
+    free(table->slots);
+    free(table->names);
+}
+
+// Copia um campo de texto removendo espaços nas pontas
+static void copyField(char* dst, size_t size, const char* src) {
+    while (*src == ' ' || *src == '\t') src++;
+    size_t len = strlen(src);
+    while (len > 0 && (src[len - 1] == ' ' || src[len - 1] == '\t')) len--;
+    if (len >= size) len = size - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+// Leitura rápida de números decimais ([-+]dígitos[.dígitos][e[-+]dígitos]); o strtod
+// fica só para formatos incomuns. É o trecho mais executado em catálogos grandes.
+static int parseNumber(const char* field, double* out) {
+    const char* p = field;
+    while (*p == ' ' || *p == '\t') p++;
+
+    bool negative = false;
+    if (*p == '-' || *p == '+') negative = (*p++ == '-');
+
+    double value = 0.0;
+    int digits = 0;
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10.0 + (*p++ - '0');
+        digits++;
+    }
+    if (*p == '.') {
+        p++;
+        double scale = 0.1;
+        while (*p >= '0' && *p <= '9') {
+            value += (*p++ - '0') * scale;
+            scale *= 0.1;
+            digits++;
+        }
+    }
+    if (digits == 0) {
+        // Formato incomum (inf, nan, hexadecimal...)
+        char* end;
+        *out = strtod(field, &end);
+        if (end == field) return 0;
+        while (*end == ' ' || *end == '\t') end++;
+        return *end == '\0';
+    }
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        bool negativeExponent = false;
+        if (*p == '-' || *p == '+') negativeExponent = (*p++ == '-');
+        if (*p < '0' || *p > '9') return 0;
+        int exponent = 0;
+        while (*p >= '0' && *p <= '9') {
+            exponent = exponent * 10 + (*p++ - '0');
+            if (exponent > 400) exponent = 400;
+        }
+        value *= pow(10.0, negativeExponent ? -exponent : exponent);
+    }
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p != '\0') return 0;
+
+    *out = negative ? -value : value;
+    return 1;
+}
+
+// Interpreta uma linha (já sem o '\n'). Retorna 1 se gerou um corpo, 0 se a linha
+// deve ser ignorada e -1 se a leitura deve parar. seenRecord marca se já passou
+// uma linha com dados: só a primeira pode ser o cabeçalho.
+static int parseLine(char* line, int lineNumber, const char* filename, NameTable* names,
+                     bool* seenRecord, CatalogCallback callback, void* userData) {
+    size_t len = strlen(line);
+    if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+
+    char* p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '\0' || *p == '#') return 0;
+    bool firstRecord = !*seenRecord;
+    *seenRecord = true;
+
+    // Separar os campos no lugar
+    char* fields[CATALOG_FIELD_COUNT];
+    int fieldCount = 0;
+    fields[fieldCount++] = line;
+    for (char* c = line; *c; c++) {
+        if (*c == ',') {
+            *c = '\0';
+            if (fieldCount == CATALOG_FIELD_COUNT) {
+                fieldCount++;
+                break;
+            }
+            fields[fieldCount++] = c + 1;
+        }
+    }
+    if (fieldCount != CATALOG_FIELD_COUNT) {
+        fprintf(stderr, "Catálogo %s, linha %d: esperados %d campos, encontrados %d\n",
+                filename, lineNumber, CATALOG_FIELD_COUNT, fieldCount);
+        return 0;
+    }
+
+    CatalogEntry entry;
+    copyField(entry.name, sizeof(entry.name), fields[0]);
+    if (firstRecord && strcmp(entry.name, "nome") == 0) return 0; // Linha de cabeçalho
+
+    double values[CATALOG_FIELD_COUNT];
+    static const int numericFields[] = { 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 15, 16, 17, 18, 19 };
+    for (size_t k = 0; k < sizeof(numericFields) / sizeof(numericFields[0]); k++) {
+        int f = numericFields[k];
+        if (!parseNumber(fields[f], &values[f])) {
+            fprintf(stderr, "Catálogo %s, linha %d: valor inválido no campo %d\n",
+                    filename, lineNumber, f + 1);
+            return 0;
+        }
+    }
+
+    char parentName[CATALOG_NAME_LENGTH];
+    copyField(parentName, sizeof(parentName), fields[1]);
+    entry.parent = -1;
+    if (parentName[0] != '\0') {
+        entry.parent = findName(names, parentName);
+        if (entry.parent < 0) {
+            fprintf(stderr, "Catálogo %s, linha %d: corpo pai '%s' não encontrado (deve vir antes)\n",
+                    filename, lineNumber, parentName);
+            return 0;
+        }
+    }
+
+    entry.mass = values[2];
+    entry.radius = (float)values[3];
+    entry.orbit.semiMajorAxis = (float)values[4];
+    entry.orbit.eccentricity = (float)values[5];
+    entry.orbit.inclination = (float)values[6];
+    entry.orbit.ascendingNode = (float)values[7];
+    entry.orbit.argPeriapsis = (float)values[8];
+    entry.meanAnomaly = (float)values[9];
+    entry.orbitalSpeed = (float)values[10];
+    entry.axialTilt = (float)values[11];
+    entry.rotationSpeed = (float)values[12];
+    copyField(entry.texture, sizeof(entry.texture), fields[13]);
+    entry.r = (float)values[14];
+    entry.g = (float)values[15];
+    entry.b = (float)values[16];
+    entry.orbit.r = (float)values[17];
+    entry.orbit.g = (float)values[18];
+    entry.orbit.b = (float)values[19];
+
+    if (entry.orbit.eccentricity < 0.0f || entry.orbit.eccentricity >= 1.0f) {
+        fprintf(stderr, "Catálogo %s, linha %d: excentricidade deve estar em [0, 1)\n",
+                filename, lineNumber);
+        return 0;
+    }
+
+    int index = names->count;
+    if (!addName(names, entry.name)) {
+        fprintf(stderr, "Erro: Falha ao alocar memória para o catálogo.\n");
+        return -1;
+    }
+    return callback(&entry, index, userData) ? 1 : -1;
+}
+
+int loadCatalog(const char* filename, CatalogCallback callback, void* userData) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Falha ao abrir catálogo: %s\n", filename);
+        return -1;
+    }
+
+    // Buffer com espaço para um bloco novo mais o resto da linha incompleta anterior
+    size_t capacity = 2 * CATALOG_CHUNK_SIZE;
+    char* buffer = malloc(capacity + 1);
+    if (!buffer) {
+        fclose(file);
+        return -1;
+    }
+
+    NameTable names = { 0 };
+    size_t pending = 0;   // Bytes de uma linha incompleta no início do buffer
+    int lineNumber = 0;
+    bool seenRecord = false;
+    int result = 0;
+    int eof = 0;
+
+    while (!eof && result >= 0) {
+        // Garantir espaço para mais um bloco (linhas muito longas aumentam o buffer)
+        if (capacity - pending < CATALOG_CHUNK_SIZE) {
+            capacity *= 2;
+            char* newBuffer = realloc(buffer, capacity + 1);
+            if (!newBuffer) {
+                result = -1;
+                break;
+            }
+            buffer = newBuffer;
+        }
+
+        size_t readBytes = fread(buffer + pending, 1, CATALOG_CHUNK_SIZE, file);
+        size_t size = pending + readBytes;
+        if (readBytes < CATALOG_CHUNK_SIZE) {
+            eof = 1;
+            buffer[size++] = '\n'; // Termina a última linha mesmo sem '\n' no arquivo
+        }
+
+        // Processar todas as linhas completas deste bloco
+        char* start = buffer;
+        char* end = buffer + size;
+        char* newline;
+        while (result >= 0 && (newline = memchr(start, '\n', (size_t)(end - start))) != NULL) {
+            *newline = '\0';
+            lineNumber++;
+            int status = parseLine(start, lineNumber, filename, &names, &seenRecord,
+                                   callback, userData);
+            if (status < 0) {
+                result = -1;
+            } else {
+                result += status;
+            }
+            start = newline + 1;
+        }
+
+        // Mover o resto da linha incompleta para o início do buffer
+        pending = (size_t)(end - start);
+        memmove(buffer, start, pending);
+    }
+
+    if (ferror(file)) {
+        fprintf(stderr, "Erro ao ler catálogo: %s\n", filename);
+        result = -1;
+    }
+
+    freeNameTable(&names);
+    free(buffer);
+    fclose(file);
+    return result;
+}
@@ -0,0 +1,44 @@
+#ifndef CATALOGO_H
+#define CATALOGO_H
+
+#include "orbitas.h"
+
+// Catálogo de corpos celestes em CSV, uma linha por corpo:
+//
+//   nome,pai,massa,raio,semi_eixo_maior,excentricidade,inclinacao,nodo_ascendente,
+//   arg_periastro,anomalia_inicial,velocidade_orbital,inclinacao_axial,
+//   velocidade_rotacao,textura,cor_r,cor_g,cor_b,orbita_r,orbita_g,orbita_b
+//
+// Linhas vazias e linhas iniciadas por '#' são ignoradas, assim como a primeira
+// linha com dados se o nome for "nome" (o cabeçalho acima). Ângulos em graus,
+// distâncias e raios em unidades GL, velocidades em graus por unidade de tempo
+// da simulação. O pai (vazio se não houver) precisa aparecer antes do filho.
+// Campos não podem conter vírgulas. Corpos pequenos sem textura (ver
+// SMALL_BODY_RADIUS em corpos_menores.h) são desenhados como pontos.
+
+#define CATALOG_NAME_LENGTH 50
+#define CATALOG_PATH_LENGTH 256
+
+typedef struct {
+    char name[CATALOG_NAME_LENGTH];
+    int parent;                        // Índice do corpo pai no catálogo, -1 se não houver
+    double mass;                       // Massa em kg
+    float radius;                      // Raio visual em unidades GL
+    OrbitPath orbit;                   // Elementos orbitais e cor da linha da órbita
+    float meanAnomaly;                 // Anomalia média inicial em graus
+    float orbitalSpeed;                // Variação da anomalia média (graus por unidade de tempo)
+    float axialTilt;                   // Inclinação axial em graus
+    float rotationSpeed;               // Velocidade de rotação (negativa = retrógrada)
+    char texture[CATALOG_PATH_LENGTH]; // Caminho da textura, vazio se não houver
+    float r, g, b;                     // Cor do corpo (usada sem textura)
+} CatalogEntry;
+
+// Chamada para cada corpo lido, na ordem do arquivo. O índice é a posição do
+// corpo no catálogo. Retornar 0 interrompe a leitura.
+typedef int (*CatalogCallback)(const CatalogEntry* entry, int index, void* userData);
+
+// Lê o catálogo em blocos, sem carregar o arquivo inteiro na memória.
+// Retorna o número de corpos lidos ou -1 em caso de erro.
+int loadCatalog(const char* filename, CatalogCallback callback, void* userData);
+
+#endif
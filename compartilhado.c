@@ -0,0 +1,160 @@
+#include "compartilhado.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Tentativas de leitura antes de desistir; depois das primeiras, a cada falha o
+// leitor cede o processador para o escritor terminar
+#define READ_ATTEMPTS 1000
+#define READ_SPINS 16
+
+_Static_assert(sizeof(SharedStateHeader) == 64, "layout do cabeçalho compartilhado mudou");
+_Static_assert(sizeof(SharedBody) == 56, "layout do corpo compartilhado mudou");
+
+static char segmentName[256];
+static SharedStateHeader* segment = NULL;
+static size_t segmentSize = 0;
+
+static size_t sizeFor(uint32_t capacity) {
+    return sizeof(SharedStateHeader) + (size_t)capacity * sizeof(SharedBody);
+}
+
+static SharedBody* bodiesOf(const SharedStateHeader* header) {
+    return (SharedBody*)(header + 1);
+}
+
+bool startSharedState(const char* name, int capacity) {
+    if (segment || capacity <= 0) return false;
+    if (snprintf(segmentName, sizeof(segmentName), "%s", name) >= (int)sizeof(segmentName)) {
+        fprintf(stderr, "Nome de memória compartilhada longo demais: %s\n", name);
+        return false;
+    }
+
+    // Um segmento antigo (de uma execução interrompida) pode ter outro tamanho
+    shm_unlink(segmentName);
+    int fd = shm_open(segmentName, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        perror("Falha ao criar a memória compartilhada");
+        return false;
+    }
+    size_t size = sizeFor((uint32_t)capacity);
+    if (ftruncate(fd, (off_t)size) != 0) {
+        perror("Falha ao dimensionar a memória compartilhada");
+        close(fd);
+        shm_unlink(segmentName);
+        return false;
+    }
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        perror("Falha ao mapear a memória compartilhada");
+        shm_unlink(segmentName);
+        return false;
+    }
+
+    // O segmento novo vem zerado: sequence par e nenhum corpo. O magic por último,
+    // para um leitor não aceitar o cabeçalho pela metade.
+    segment = memory;
+    segmentSize = size;
+    segment->version = SHARED_STATE_VERSION;
+    segment->capacity = (uint32_t)capacity;
+    segment->bodySize = sizeof(SharedBody);
+    atomic_thread_fence(memory_order_release);
+    segment->magic = SHARED_STATE_MAGIC;
+
+    atexit(stopSharedState);
+    printf("Estado publicado na memória compartilhada %s (%d corpos, %zu bytes)\n",
+           segmentName, capacity, size);
+    return true;
+}
+
+bool sharedStateActive(void) {
+    return segment != NULL;
+}
+
+SharedBody* beginSharedStateWrite(void) {
+    if (!segment) return NULL;
+    uint64_t sequence = atomic_load_explicit(&segment->sequence, memory_order_relaxed);
+    atomic_store_explicit(&segment->sequence, sequence + 1, memory_order_relaxed);
+    // Os leitores precisam ver a sequência ímpar antes de qualquer dado novo
+    atomic_thread_fence(memory_order_release);
+    return bodiesOf(segment);
+}
+
+void endSharedStateWrite(int bodyCount, uint64_t step, double time) {
+    if (!segment) return;
+    if (bodyCount > (int)segment->capacity) bodyCount = (int)segment->capacity;
+    segment->step = step;
+    segment->time = time;
+    segment->bodyCount = (uint32_t)(bodyCount > 0 ? bodyCount : 0);
+    uint64_t sequence = atomic_load_explicit(&segment->sequence, memory_order_relaxed);
+    atomic_store_explicit(&segment->sequence, sequence + 1, memory_order_release);
+}
+
+void stopSharedState(void) {
+    if (!segment) return;
+    munmap(segment, segmentSize);
+    shm_unlink(segmentName);
+    segment = NULL;
+}
+
+const SharedStateHeader* attachSharedState(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SharedStateHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)info.st_size;
+    const SharedStateHeader* header = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) return NULL;
+
+    bool valid = header->magic == SHARED_STATE_MAGIC;
+    atomic_thread_fence(memory_order_acquire);
+    valid = valid && header->version == SHARED_STATE_VERSION &&
+            header->bodySize == sizeof(SharedBody) && size >= sizeFor(header->capacity);
+    if (!valid) {
+        munmap((void*)header, size);
+        return NULL;
+    }
+    return header;
+}
+
+void detachSharedState(const SharedStateHeader* header) {
+    if (header) munmap((void*)header, sizeFor(header->capacity));
+}
+
+bool readSharedState(const SharedStateHeader* header, SharedBody* bodies, int capacity,
+                     SharedStateInfo* info) {
+    // O cabeçalho é só leitura aqui, mas a carga atômica pede um ponteiro não const
+    _Atomic uint64_t* sequence = (_Atomic uint64_t*)&header->sequence;
+    for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+        if (attempt >= READ_SPINS) sched_yield();
+        uint64_t before = atomic_load_explicit(sequence, memory_order_acquire);
+        if (before & 1) continue; // Escrita em andamento
+
+        uint32_t count = header->bodyCount;
+        if (count > header->capacity) continue; // Lido no meio de uma escrita
+        int copied = (int)count < capacity ? (int)count : capacity;
+        uint64_t step = header->step;
+        double time = header->time;
+        memcpy(bodies, bodiesOf(header), (size_t)copied * sizeof(SharedBody));
+
+        // As cópias acima precisam terminar antes da segunda leitura da sequência
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(sequence, memory_order_relaxed) != before) continue;
+
+        info->step = step;
+        info->time = time;
+        info->bodyCount = copied;
+        return true;
+    }
+    return false;
+}
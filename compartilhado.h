@@ -0,0 +1,74 @@
+#ifndef COMPARTILHADO_H
+#define COMPARTILHADO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Estado da simulação publicado em memória compartilhada POSIX (shm_open), para
+// outros programas lerem posições e velocidades sem passar pela saída do terminal.
+//
+// O segmento tem um cabeçalho e um vetor de corpos. Um único escritor (a
+// simulação) atualiza tudo uma vez por passo, protegido por um seqlock: sequence
+// fica ímpar durante a escrita e volta a par no fim. Um leitor copia o estado e
+// confere que sequence não mudou e estava par; senão copia de novo. O escritor
+// nunca espera pelos leitores, e eles podem ler no ritmo que quiserem.
+//
+// Leitores em C usam attachSharedState e readSharedState; os de outras linguagens
+// seguem o mesmo protocolo com o layout abaixo (little-endian, alinhamento natural).
+
+#define SHARED_STATE_MAGIC 0x4c4f5353u // "SSOL"
+#define SHARED_STATE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;          // Corpos que cabem no segmento
+    uint32_t bodySize;          // sizeof(SharedBody)
+    _Atomic uint64_t sequence;  // Ímpar durante a escrita
+    // Protegidos pelo seqlock
+    uint64_t step;              // Passos simulados
+    double time;                // Tempo simulado
+    uint32_t bodyCount;
+    uint32_t reserved;
+    unsigned char padding[16];  // Cabeçalho com 64 bytes
+} SharedStateHeader;
+
+typedef struct {
+    int32_t id;                 // Ordem de criação do corpo (o índice no vetor muda)
+    uint32_t fixed;             // 1 se o corpo não se move
+    double position[3];         // Unidades GL
+    double velocity[3];
+} SharedBody;
+
+// Estado lido, com os corpos no buffer de quem chamou
+typedef struct {
+    uint64_t step;
+    double time;
+    int bodyCount;
+} SharedStateInfo;
+
+// Escritor: cria (ou recria) o segmento name (começando com '/') para capacity
+// corpos. O segmento é removido na saída do programa.
+bool startSharedState(const char* name, int capacity);
+
+bool sharedStateActive(void);
+
+// Começa a escrita de um passo e devolve o vetor de corpos do segmento, para ser
+// preenchido no lugar (NULL sem segmento). Terminar com endSharedStateWrite.
+SharedBody* beginSharedStateWrite(void);
+void endSharedStateWrite(int bodyCount, uint64_t step, double time);
+
+// Remove o segmento (os leitores que já o mapearam continuam lendo o último estado)
+void stopSharedState(void);
+
+// Leitor: mapeia o segmento só para leitura (NULL se não existir ou não for desta versão)
+const SharedStateHeader* attachSharedState(const char* name);
+void detachSharedState(const SharedStateHeader* header);
+
+// Copia um estado consistente para bodies (até capacity corpos; info->bodyCount
+// diz quantos). Retorna false se o escritor ficou escrevendo em todas as tentativas.
+bool readSharedState(const SharedStateHeader* header, SharedBody* bodies, int capacity,
+                     SharedStateInfo* info);
+
+#endif
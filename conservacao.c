@@ -0,0 +1,148 @@
+#include "conservacao.h"
+#include <stdio.h>
+#include <math.h>
+
+typedef enum {
+    QUANTITY_ENERGY,
+    QUANTITY_MOMENTUM,
+    QUANTITY_ANGULAR_MOMENTUM,
+    QUANTITY_COUNT
+} ConservedQuantity;
+
+static const char* quantityNames[QUANTITY_COUNT] = {
+    "energia", "momento linear", "momento angular"
+};
+
+static FILE* metricsFile = NULL;
+static int cadence = DEFAULT_POTENTIAL_CADENCE;
+static double alarmThreshold = DEFAULT_DRIFT_ALARM;
+static long step = 0;
+
+// Valores do primeiro passo, referência da deriva
+static bool hasReference[QUANTITY_COUNT];
+static double initialEnergy;
+static double energyScale;
+static double initialMomentum[3];
+static double initialAngularMomentum[3];
+
+static double maxDrift[QUANTITY_COUNT];
+static bool alarmRaised[QUANTITY_COUNT];
+static long alarmCount = 0;
+static bool momentumChecked = false; // Algum passo sem corpos fixos
+
+bool startConservationMonitor(const char* path, int potentialCadence, double driftAlarm) {
+    metricsFile = fopen(path, "w");
+    if (!metricsFile) {
+        fprintf(stderr, "Falha ao criar arquivo de métricas: %s\n", path);
+        return false;
+    }
+    cadence = potentialCadence > 0 ? potentialCadence : 1;
+    alarmThreshold = driftAlarm;
+    step = 0;
+    alarmCount = 0;
+    momentumChecked = false;
+    for (int q = 0; q < QUANTITY_COUNT; q++) {
+        hasReference[q] = false;
+        maxDrift[q] = 0.0;
+        alarmRaised[q] = false;
+    }
+    printf("Monitor de conservação: %s (potencial a cada %d passos, alarme acima de %g)\n",
+           path, cadence, alarmThreshold);
+    return true;
+}
+
+bool conservationMonitorActive(void) {
+    return metricsFile != NULL;
+}
+
+bool conservationPotentialDue(void) {
+    return metricsFile && step % cadence == 0;
+}
+
+static double length3(const double v[3]) {
+    return sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+// Módulo da diferença sobre o módulo inicial (ou a escala, se o total começou ~0)
+static double vectorDrift(const double value[3], const double initial[3], double scale) {
+    double difference[3] = { value[0] - initial[0], value[1] - initial[1], value[2] - initial[2] };
+    double reference = fmax(length3(initial), scale);
+    return reference > 0.0 ? length3(difference) / reference : 0.0;
+}
+
+// Guarda a maior deriva e liga ou desliga o alarme da grandeza
+static void checkDrift(ConservedQuantity quantity, double drift, double time) {
+    if (drift > maxDrift[quantity]) maxDrift[quantity] = drift;
+    if (drift > alarmThreshold && !alarmRaised[quantity]) {
+        alarmRaised[quantity] = true;
+        alarmCount++;
+        fprintf(stderr, "Alarme: deriva relativa de %s %.3g no passo %ld (tempo %.3f, limite %g)\n",
+                quantityNames[quantity], drift, step, time, alarmThreshold);
+    } else if (drift <= alarmThreshold) {
+        alarmRaised[quantity] = false;
+    }
+}
+
+void submitConservationSample(const ConservationSample* sample) {
+    if (!metricsFile) return;
+
+    fprintf(metricsFile, "{\"passo\": %ld, \"tempo\": %.9g, \"cinetica\": %.12g", step, sample->time, sample->kinetic);
+
+    if (sample->hasPotential) {
+        double energy = sample->kinetic + sample->potential;
+        if (!hasReference[QUANTITY_ENERGY]) {
+            hasReference[QUANTITY_ENERGY] = true;
+            initialEnergy = energy;
+            // Energia total perto de zero: a deriva é medida contra as parcelas
+            energyScale = fmax(fabs(energy), fabs(sample->kinetic) + fabs(sample->potential));
+        }
+        double drift = energyScale > 0.0 ? fabs(energy - initialEnergy) / energyScale : 0.0;
+        checkDrift(QUANTITY_ENERGY, drift, sample->time);
+        fprintf(metricsFile, ", \"potencial\": %.12g, \"energia\": %.12g, \"deriva_energia\": %.6g",
+                sample->potential, energy, drift);
+    }
+
+    if (!hasReference[QUANTITY_MOMENTUM]) {
+        hasReference[QUANTITY_MOMENTUM] = hasReference[QUANTITY_ANGULAR_MOMENTUM] = true;
+        for (int k = 0; k < 3; k++) {
+            initialMomentum[k] = sample->momentum[k];
+            initialAngularMomentum[k] = sample->angularMomentum[k];
+        }
+    }
+    fprintf(metricsFile, ", \"momento\": [%.12g, %.12g, %.12g]",
+            sample->momentum[0], sample->momentum[1], sample->momentum[2]);
+    if (sample->momentumConserved) {
+        momentumChecked = true;
+        double drift = vectorDrift(sample->momentum, initialMomentum, sample->momentumScale);
+        checkDrift(QUANTITY_MOMENTUM, drift, sample->time);
+        fprintf(metricsFile, ", \"deriva_momento\": %.6g", drift);
+    }
+
+    double angularDrift = vectorDrift(sample->angularMomentum, initialAngularMomentum,
+                                      sample->angularMomentumScale);
+    checkDrift(QUANTITY_ANGULAR_MOMENTUM, angularDrift, sample->time);
+    fprintf(metricsFile, ", \"momento_angular\": [%.12g, %.12g, %.12g], \"deriva_momento_angular\": %.6g",
+            sample->angularMomentum[0], sample->angularMomentum[1], sample->angularMomentum[2], angularDrift);
+
+    fprintf(metricsFile, ", \"pares_proximos\": %d", sample->closePairs);
+
+    bool alarm = alarmRaised[QUANTITY_ENERGY] || alarmRaised[QUANTITY_MOMENTUM]
+              || alarmRaised[QUANTITY_ANGULAR_MOMENTUM];
+    fprintf(metricsFile, ", \"alarme\": %s}\n", alarm ? "true" : "false");
+    step++;
+}
+
+void stopConservationMonitor(void) {
+    if (!metricsFile) return;
+    fclose(metricsFile);
+    metricsFile = NULL;
+
+    printf("Conservação em %ld passos: deriva máxima de energia %.3g, de momento angular %.3g",
+           step, maxDrift[QUANTITY_ENERGY], maxDrift[QUANTITY_ANGULAR_MOMENTUM]);
+    if (momentumChecked) {
+        printf(", de momento linear %.3g", maxDrift[QUANTITY_MOMENTUM]);
+    } else {
+        printf(" (momento linear não conservado: há corpos fixos)");
+    }
+    printf(", %ld alarmes\n", alarmCount);
+}
@@ -0,0 +1,39 @@
+#ifndef CONSERVACAO_H
+#define CONSERVACAO_H
+
+#include <stdbool.h>
+
+#include "simulacao.h"
+
+// Monitor das leis de conservação da simulação gravitacional: energia total,
+// momento linear e momento angular, comparados com os valores do primeiro passo
+// para detectar a deriva do integrador. Energia cinética e momentos custam O(N) e
+// são medidos a cada passo; a energia potencial é somada no próprio laço dos pares
+// das forças da simulação (simulacao.c), só nos passos da cadência configurada.
+//
+// Cada passo vira uma linha JSON no arquivo de métricas; quando a deriva relativa
+// de uma grandeza passa do limite, um alarme é escrito no terminal (e de novo só
+// depois de ela voltar para baixo do limite).
+
+#define DEFAULT_POTENTIAL_CADENCE 10
+#define DEFAULT_DRIFT_ALARM 1e-3
+
+// Grandezas de um passo, medidas pela simulação no estado antes da integração
+typedef SimConservation ConservationSample;
+
+// Começa a escrever as métricas em path. A energia potencial é medida a cada
+// potentialCadence passos e driftAlarm é a deriva relativa que dispara o alarme.
+bool startConservationMonitor(const char* path, int potentialCadence, double driftAlarm);
+
+bool conservationMonitorActive(void);
+
+// Se o passo atual deve somar a energia potencial
+bool conservationPotentialDue(void);
+
+// Registra as grandezas do passo e confere a deriva
+void submitConservationSample(const ConservationSample* sample);
+
+// Fecha o arquivo e mostra a maior deriva de cada grandeza
+void stopConservationMonitor(void);
+
+#endif
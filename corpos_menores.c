@@ -0,0 +1,456 @@
+#include "corpos_menores.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include "memoria.h"
+#include "simulacao.h"
+
+// Regiões do buffer de posições usadas em rodízio: a CPU escreve em uma enquanto
+// a GPU ainda pode estar lendo as anteriores
+#define POSITION_REGIONS 3
+
+// Elementos orbitais em estrutura de arrays, para o laço de atualização vetorizar
+typedef struct {
+    float* a;             // Semi-eixo maior
+    float* b;             // Semi-eixo menor
+    float* e;             // Excentricidade
+    float* px;            // Direção do periastro (vetor unitário P)
+    float* py;
+    float* pz;
+    float* qx;            // Direção perpendicular no plano da órbita (vetor unitário Q)
+    float* qy;
+    float* qz;
+    float* meanAnomaly;   // Anomalia média atual em radianos
+    float* meanMotion;    // Variação da anomalia média em radianos por unidade de tempo
+    float* eccAnomaly;    // Última anomalia excêntrica (ponto de partida do Newton)
+    int* parent;          // Índice do objeto pai, -1 para a origem
+    float* attributes;    // Cor (r, g, b) e raio de cada corpo
+} SmallBodyArrays;
+
+static SmallBodyArrays bodies;
+static int count = 0;
+static int capacity = 0;
+
+// Recursos do OpenGL
+static bool supported = false;
+static bool persistentMapping = false;
+static GLuint program = 0;
+static GLint viewLocation, projectionLocation, pointScaleLocation;
+static GLuint positionBuffer = 0;
+static GLuint attributeBuffer = 0;
+static int bufferCapacity = 0;      // Corpos que cabem em cada região do buffer
+static bool attributesDirty = true;
+static float* mappedPositions = NULL; // Buffer persistente mapeado (todas as regiões)
+static float* stagingPositions = NULL; // Usado quando não há mapeamento persistente
+static GLsync regionFences[POSITION_REGIONS];
+static size_t stagingBytes = 0;      // Contados em MEMORY_BODIES
+static size_t bufferBytes = 0;       // Buffers de posições e atributos (MEMORY_MESHES)
+static int writeRegion = 0;
+static int drawRegion = -1;
+static float pendingTimeScale = 0.0f; // Avanço de quadros em que a região não ficou livre
+
+static const char* vertexShaderSource =
+    "#version 120\n"
+    "attribute vec3 position;\n"
+    "attribute vec4 colorRadius;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "uniform float pointScale;\n"
+    "varying vec3 color;\n"
+    "varying vec3 lightDir;\n"
+    "void main() {\n"
+    "    vec4 viewPos = view * vec4(position, 1.0);\n"
+    "    gl_Position = projection * viewPos;\n"
+    "    float dist = max(-viewPos.z, 0.001);\n"
+    "    gl_PointSize = clamp(2.0 * colorRadius.w * pointScale / dist, 1.0, 32.0);\n"
+    "    color = colorRadius.rgb;\n"
+    "    vec3 sun = (view * vec4(0.0, 0.0, 0.0, 1.0)).xyz;\n"
+    "    lightDir = normalize(sun - viewPos.xyz);\n"
+    "}\n";
+
+// Impostor: o ponto é sombreado como uma esfera iluminada pelo Sol
+static const char* fragmentShaderSource =
+    "#version 120\n"
+    "varying vec3 color;\n"
+    "varying vec3 lightDir;\n"
+    "void main() {\n"
+    "    vec2 p = gl_PointCoord * 2.0 - 1.0;\n"
+    "    float r2 = dot(p, p);\n"
+    "    if (r2 > 1.0) discard;\n"
+    "    vec3 normal = vec3(p.x, -p.y, sqrt(1.0 - r2));\n"
+    "    float diffuse = max(dot(normal, lightDir), 0.0);\n"
+    "    gl_FragColor = vec4(color * (0.3 + 0.7 * diffuse), 1.0);\n"
+    "}\n";
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint ok;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Erro ao compilar shader dos corpos menores:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static bool hasExtension(const char* name) {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0) return true;
+    }
+    return false;
+}
+
+void initSmallBodies(void) {
+    int major = 0, minor = 0;
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2 || major < 2) {
+        fprintf(stderr, "Corpos menores desativados: OpenGL 2.0 não disponível\n");
+        return;
+    }
+    persistentMapping = major > 4 || (major == 4 && minor >= 4)
+                     || (major >= 3 && hasExtension("GL_ARB_buffer_storage"));
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    if (!vs || !fs) return;
+
+    program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glBindAttribLocation(program, 0, "position");
+    glBindAttribLocation(program, 1, "colorRadius");
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Erro ao ligar shader dos corpos menores:\n%s\n", log);
+        glDeleteProgram(program);
+        program = 0;
+        return;
+    }
+    viewLocation = glGetUniformLocation(program, "view");
+    projectionLocation = glGetUniformLocation(program, "projection");
+    pointScaleLocation = glGetUniformLocation(program, "pointScale");
+    supported = true;
+}
+
+static bool growArray(void** array, size_t elementSize, int newCapacity) {
+    void* grown = realloc(*array, elementSize * (size_t)newCapacity);
+    if (!grown) return false;
+    *array = grown;
+    return true;
+}
+
+static bool reserveSmallBodies(int needed) {
+    if (needed <= capacity) return true;
+    int newCapacity = capacity ? capacity : 1024;
+    while (newCapacity < needed) newCapacity *= 2;
+
+    float** floatArrays[] = {
+        &bodies.a, &bodies.b, &bodies.e, &bodies.px, &bodies.py, &bodies.pz,
+        &bodies.qx, &bodies.qy, &bodies.qz, &bodies.meanAnomaly, &bodies.meanMotion,
+        &bodies.eccAnomaly
+    };
+    for (size_t i = 0; i < sizeof(floatArrays) / sizeof(floatArrays[0]); i++) {
+        if (!growArray((void**)floatArrays[i], sizeof(float), newCapacity)) return false;
+    }
+    if (!growArray((void**)&bodies.parent, sizeof(int), newCapacity)) return false;
+    if (!growArray((void**)&bodies.attributes, 4 * sizeof(float), newCapacity)) return false;
+
+    // 12 floats, o pai e os 4 atributos por corpo
+    trackMemory(MEMORY_BODIES, (long long)(newCapacity - capacity) * (16 * sizeof(float) + sizeof(int)));
+    capacity = newCapacity;
+    return true;
+}
+
+// Converte um ponto do plano da órbita (periastro em +x) para coordenadas da cena,
+// com a mesma convenção de orbitPosition()
+static void orbitPlaneToScene(const OrbitPath* orbit, float xp, float yp, float out[3]) {
+    float w = DEG_TO_RAD(orbit->argPeriapsis);
+    float inc = DEG_TO_RAD(orbit->inclination);
+    float node = DEG_TO_RAD(orbit->ascendingNode);
+    float u = xp * cosf(w) - yp * sinf(w);
+    float v = xp * sinf(w) + yp * cosf(w);
+    out[0] = u * cosf(node) - v * cosf(inc) * sinf(node);
+    out[1] = v * sinf(inc);
+    out[2] = u * sinf(node) + v * cosf(inc) * cosf(node);
+}
+
+bool addSmallBody(const CatalogEntry* entry, int parent) {
+    if (!reserveSmallBodies(count + 1)) {
+        fprintf(stderr, "Erro: Memória insuficiente para os corpos menores.\n");
+        return false;
+    }
+
+    int i = count++;
+    float e = entry->orbit.eccentricity;
+    float p[3], q[3];
+    orbitPlaneToScene(&entry->orbit, 1.0f, 0.0f, p);
+    orbitPlaneToScene(&entry->orbit, 0.0f, 1.0f, q);
+
+    bodies.a[i] = entry->orbit.semiMajorAxis;
+    bodies.b[i] = entry->orbit.semiMajorAxis * sqrtf(1.0f - e * e);
+    bodies.e[i] = e;
+    bodies.px[i] = p[0];
+    bodies.py[i] = p[1];
+    bodies.pz[i] = p[2];
+    bodies.qx[i] = q[0];
+    bodies.qy[i] = q[1];
+    bodies.qz[i] = q[2];
+    bodies.meanAnomaly[i] = DEG_TO_RAD(entry->meanAnomaly);
+    bodies.meanMotion[i] = DEG_TO_RAD(entry->orbitalSpeed);
+    bodies.eccAnomaly[i] = simSolveKepler(bodies.meanAnomaly[i], e);
+    bodies.parent[i] = parent;
+    bodies.attributes[i * 4 + 0] = entry->r;
+    bodies.attributes[i * 4 + 1] = entry->g;
+    bodies.attributes[i * 4 + 2] = entry->b;
+    bodies.attributes[i * 4 + 3] = entry->radius;
+
+    attributesDirty = true;
+    return true;
+}
+
+// Gerador pseudoaleatório simples (xorshift) para a população ser reproduzível
+static unsigned int nextRandom(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static float randomRange(unsigned int* state, float min, float max) {
+    return min + (max - min) * (nextRandom(state) & 0xFFFFFF) / (float)0x1000000;
+}
+
+void generateAsteroidBelt(int generated, int parent, unsigned int seed) {
+    unsigned int state = seed ? seed : 1;
+    if (!reserveSmallBodies(count + generated)) {
+        fprintf(stderr, "Erro: Memória insuficiente para %d asteroides.\n", generated);
+        return;
+    }
+
+    for (int i = 0; i < generated; i++) {
+        CatalogEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.parent = parent;
+        entry.radius = randomRange(&state, 0.03f, 0.08f);
+        entry.orbit.semiMajorAxis = randomRange(&state, 17.0f, 23.0f); // Entre Marte e Júpiter
+        entry.orbit.eccentricity = randomRange(&state, 0.0f, 0.25f);
+        entry.orbit.inclination = randomRange(&state, 0.0f, 15.0f);
+        entry.orbit.ascendingNode = randomRange(&state, 0.0f, 360.0f);
+        entry.orbit.argPeriapsis = randomRange(&state, 0.0f, 360.0f);
+        entry.meanAnomaly = randomRange(&state, 0.0f, 360.0f);
+        // Terceira lei de Kepler na escala da cena (Terra: raio 10, velocidade 2.5)
+        entry.orbitalSpeed = 2.5f * powf(10.0f / entry.orbit.semiMajorAxis, 1.5f);
+        float shade = randomRange(&state, 0.45f, 0.75f);
+        entry.r = shade;
+        entry.g = shade * 0.9f;
+        entry.b = shade * 0.8f;
+        addSmallBody(&entry, parent);
+    }
+}
+
+int smallBodyCount(void) {
+    return count;
+}
+
+// (Re)cria os buffers quando o número de corpos muda
+static bool ensureBuffers(void) {
+    if (bufferCapacity == count && positionBuffer != 0) return true;
+
+    if (positionBuffer != 0) {
+        for (int r = 0; r < POSITION_REGIONS; r++) {
+            if (regionFences[r]) glDeleteSync(regionFences[r]);
+            regionFences[r] = 0;
+        }
+        glDeleteBuffers(1, &positionBuffer);
+        positionBuffer = 0;
+        mappedPositions = NULL;
+    }
+    free(stagingPositions);
+    stagingPositions = NULL;
+    trackMemorySize(MEMORY_BODIES, &stagingBytes, 0);
+
+    glGenBuffers(1, &positionBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    if (persistentMapping) {
+        GLsizeiptr bytes = (GLsizeiptr)count * 3 * sizeof(float) * POSITION_REGIONS;
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+        mappedPositions = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+        if (!mappedPositions) {
+            fprintf(stderr, "Aviso: Falha ao mapear buffer dos corpos menores, usando cópia.\n");
+            persistentMapping = false;
+            glDeleteBuffers(1, &positionBuffer);
+            glGenBuffers(1, &positionBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+        }
+    }
+    if (!persistentMapping) {
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)count * 3 * sizeof(float), NULL, GL_STREAM_DRAW);
+        stagingPositions = malloc((size_t)count * 3 * sizeof(float));
+        if (!stagingPositions) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            return false;
+        }
+        trackMemorySize(MEMORY_BODIES, &stagingBytes, (size_t)count * 3 * sizeof(float));
+    }
+    int regions = persistentMapping ? POSITION_REGIONS : 1;
+    trackMemorySize(MEMORY_MESHES, &bufferBytes, (size_t)count * (3 * regions + 4) * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    bufferCapacity = count;
+    writeRegion = 0;
+    drawRegion = -1;
+    attributesDirty = true;
+    return true;
+}
+
+void updateSmallBodies(float timeScale, const float* parentPositions) {
+    if (!supported || count == 0 || !ensureBuffers()) return;
+
+    // Escolher onde escrever: a próxima região do buffer persistente (esperando a GPU
+    // terminar de ler o que estava nela) ou a cópia na CPU
+    float* out;
+    if (persistentMapping) {
+        if (regionFences[writeRegion]) {
+            GLenum wait = glClientWaitSync(regionFences[writeRegion], GL_SYNC_FLUSH_COMMANDS_BIT,
+                                           1000000000);
+            if (wait == GL_TIMEOUT_EXPIRED || wait == GL_WAIT_FAILED) {
+                // A GPU ainda pode estar lendo a região: continuar desenhando a anterior
+                // e tentar de novo no próximo quadro, sem perder o avanço deste. Uma
+                // cerca que falhou não serve para esperar de novo.
+                if (wait == GL_WAIT_FAILED) {
+                    glDeleteSync(regionFences[writeRegion]);
+                    regionFences[writeRegion] = 0;
+                }
+                pendingTimeScale += timeScale;
+                return;
+            }
+            glDeleteSync(regionFences[writeRegion]);
+            regionFences[writeRegion] = 0;
+        }
+        out = mappedPositions + (size_t)writeRegion * count * 3;
+    } else {
+        out = stagingPositions;
+    }
+
+    // Equação de Kepler por Newton partindo da anomalia do quadro anterior:
+    // como ela muda pouco por quadro, duas iterações bastam
+    timeScale += pendingTimeScale;
+    pendingTimeScale = 0.0f;
+    float step = DEG_TO_RAD(timeScale);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; i++) {
+        float M = bodies.meanAnomaly[i] + bodies.meanMotion[i] * step;
+        float E = bodies.eccAnomaly[i] + bodies.meanMotion[i] * step;
+        // Voltar as duas anomalias juntas para o Newton continuar coerente (nos dois
+        // sentidos: velocidade_orbital negativa é uma órbita retrógrada)
+        if (M > 2.0f * (float)M_PI) {
+            M -= 2.0f * (float)M_PI;
+            E -= 2.0f * (float)M_PI;
+        } else if (M < 0.0f) {
+            M += 2.0f * (float)M_PI;
+            E += 2.0f * (float)M_PI;
+        }
+        bodies.meanAnomaly[i] = M;
+
+        float e = bodies.e[i];
+        for (int k = 0; k < 2; k++) {
+            E -= (E - e * sinf(E) - M) / (1.0f - e * cosf(E));
+        }
+        bodies.eccAnomaly[i] = E;
+
+        float xp = bodies.a[i] * (cosf(E) - e);
+        float yp = bodies.b[i] * sinf(E);
+        float x = xp * bodies.px[i] + yp * bodies.qx[i];
+        float y = xp * bodies.py[i] + yp * bodies.qy[i];
+        float z = xp * bodies.pz[i] + yp * bodies.qz[i];
+
+        int parent = bodies.parent[i];
+        if (parent >= 0) {
+            x += parentPositions[parent * 3 + 0];
+            y += parentPositions[parent * 3 + 1];
+            z += parentPositions[parent * 3 + 2];
+        }
+        out[i * 3 + 0] = x;
+        out[i * 3 + 1] = y;
+        out[i * 3 + 2] = z;
+    }
+
+    if (!persistentMapping) {
+        GLsizeiptr bytes = (GLsizeiptr)count * 3 * sizeof(float);
+        glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, stagingPositions);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    drawRegion = persistentMapping ? writeRegion : 0;
+    if (persistentMapping) {
+        writeRegion = (writeRegion + 1) % POSITION_REGIONS;
+    }
+}
+
+void drawSmallBodies(const Mat4* view, const Mat4* projection, int viewportHeight) {
+    if (!supported || count == 0 || drawRegion < 0) return;
+
+    // Cor e raio só mudam quando corpos são adicionados
+    if (attributesDirty) {
+        if (attributeBuffer == 0) glGenBuffers(1, &attributeBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, attributeBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)count * 4 * sizeof(float),
+                     bodies.attributes, GL_STATIC_DRAW);
+        attributesDirty = false;
+    }
+
+    glUseProgram(program);
+    glUniformMatrix4fv(viewLocation, 1, GL_FALSE, view->m);
+    glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, projection->m);
+    // Pixels por unidade GL a uma unidade de distância: m[5] = 1 / tan(fov / 2)
+    glUniform1f(pointScaleLocation, projection->m[5] * viewportHeight * 0.5f);
+
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glEnable(GL_POINT_SPRITE);
+
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0,
+                          (const void*)((size_t)drawRegion * count * 3 * sizeof(float)));
+    glBindBuffer(GL_ARRAY_BUFFER, attributeBuffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, (const void*)0);
+
+    glDrawArrays(GL_POINTS, 0, count);
+
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisable(GL_POINT_SPRITE);
+    glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glUseProgram(0);
+
+    // Marcar quando a GPU terminar de ler esta região
+    if (persistentMapping) {
+        if (regionFences[drawRegion]) glDeleteSync(regionFences[drawRegion]);
+        regionFences[drawRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
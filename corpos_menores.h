@@ -0,0 +1,35 @@
+#ifndef CORPOS_MENORES_H
+#define CORPOS_MENORES_H
+
+#include <stdbool.h>
+
+#include "catalogo.h"
+#include "matematica.h"
+
+// Camada de corpos menores (asteroides, cometas): cada corpo é desenhado como um
+// ponto (impostor esférico) em vez de uma esfera com textura. As posições são
+// calculadas direto no buffer de vértices mapeado, e todos os pontos saem em uma
+// única chamada de desenho.
+
+// Corpos do catálogo com raio menor que este (e sem textura) vão para esta camada
+#define SMALL_BODY_RADIUS 0.1f
+
+// Compila o shader e verifica os recursos do OpenGL. Chamar após criar o contexto GL.
+void initSmallBodies(void);
+
+// Adiciona um corpo menor. parent é o índice do corpo pai no array de objetos (-1 = origem).
+bool addSmallBody(const CatalogEntry* entry, int parent);
+
+// Gera count asteroides no cinturão principal (entre Marte e Júpiter) ao redor do pai
+void generateAsteroidBelt(int count, int parent, unsigned int seed);
+
+int smallBodyCount(void);
+
+// Avança as órbitas (anomalias em graus multiplicadas por timeScale) e escreve as
+// posições no buffer de vértices. parentPositions tem x, y, z de cada objeto pai.
+void updateSmallBodies(float timeScale, const float* parentPositions);
+
+// Desenha todos os corpos menores com tamanho proporcional à distância
+void drawSmallBodies(const Mat4* view, const Mat4* projection, int viewportHeight);
+
+#endif
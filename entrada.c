@@ -0,0 +1,290 @@
+#include "entrada.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <GL/glut.h>
+
+#define INPUT_LINE_LENGTH 256
+
+// Diferença relativa do tempo simulado a partir da qual a repetição divergiu
+#define SIMULATION_TIME_TOLERANCE 1e-9
+
+typedef enum {
+    INPUT_IDLE,
+    INPUT_RECORDING,
+    INPUT_REPLAYING
+} InputMode;
+
+// Um registro da gravação; o significado de a, b, c e d depende do tipo (ver entrada.h)
+typedef struct {
+    char type;
+    double ms;
+    double simulationTime;
+    int a, b, c, d;
+} InputEvent;
+
+static InputMode mode = INPUT_IDLE;
+static InputHandlers handlers;
+static double startMs = 0.0;
+static int frameNumber = 0;
+
+// Gravação
+static FILE* recordFile = NULL;
+
+// Repetição: a gravação inteira fica na memória para não ler o disco entre quadros
+static InputEvent* events = NULL;
+static int eventCount = 0;
+static int nextEvent = 0;
+static double recordedMs = 0.0;      // Duração da sessão gravada
+static int divergedFrame = -1;       // Primeiro quadro com tempo simulado diferente
+static double* frameTimes = NULL;    // Intervalo entre o início de cada quadro e o do seguinte
+static int frameTimeCapacity = 0;
+static int measuredFrames = 0;
+static double lastFrameStart = 0.0;
+
+static double nowMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+static double elapsedMs(void) {
+    return nowMs() - startMs;
+}
+
+bool startInputRecording(const char* path, int width, int height) {
+    recordFile = fopen(path, "w");
+    if (!recordFile) {
+        fprintf(stderr, "Falha ao criar gravação da entrada: %s\n", path);
+        return false;
+    }
+    fprintf(recordFile, "j,%d,%d\n", width, height);
+    mode = INPUT_RECORDING;
+    startMs = nowMs();
+    frameNumber = 0;
+    printf("Gravando a entrada em %s\n", path);
+    return true;
+}
+
+static bool appendEvent(const InputEvent* event, int* capacity) {
+    if (eventCount == *capacity) {
+        int newCapacity = *capacity ? *capacity * 2 : 256;
+        InputEvent* newEvents = realloc(events, (size_t)newCapacity * sizeof(InputEvent));
+        if (!newEvents) return false;
+        events = newEvents;
+        *capacity = newCapacity;
+    }
+    events[eventCount++] = *event;
+    return true;
+}
+
+bool startInputReplay(const char* path, int* width, int* height) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Falha ao abrir gravação da entrada: %s\n", path);
+        return false;
+    }
+
+    char line[INPUT_LINE_LENGTH];
+    int lineNumber = 0;
+    int capacity = 0;
+    int frames = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        if (line[0] == '\n' || line[0] == '#') continue;
+
+        InputEvent event = { .type = line[0] };
+        int fields = 0, expected = 0;
+        switch (line[0]) {
+            case 'j':
+                fields = sscanf(line, "j,%d,%d", width, height);
+                expected = 2;
+                break;
+            case 'q':
+                fields = sscanf(line, "q,%d,%lf,%lf", &event.a, &event.ms, &event.simulationTime);
+                expected = 3;
+                frames++;
+                break;
+            case 't':
+                fields = sscanf(line, "t,%lf,%d,%d,%d", &event.ms, &event.a, &event.b, &event.c);
+                expected = 4;
+                break;
+            case 'm':
+                fields = sscanf(line, "m,%lf,%d,%d", &event.ms, &event.a, &event.b);
+                expected = 3;
+                break;
+            case 'b':
+                fields = sscanf(line, "b,%lf,%d,%d,%d,%d", &event.ms, &event.a, &event.b, &event.c, &event.d);
+                expected = 5;
+                break;
+            case 'e':
+                fields = sscanf(line, "e,%lf,%d", &event.ms, &event.a);
+                expected = 2;
+                break;
+        }
+        if (expected == 0 || fields != expected) {
+            fprintf(stderr, "Gravação %s, linha %d: registro inválido\n", path, lineNumber);
+            continue;
+        }
+        if (event.type != 'j' && !appendEvent(&event, &capacity)) {
+            fclose(file);
+            return false;
+        }
+        if (event.ms > recordedMs) recordedMs = event.ms;
+    }
+    fclose(file);
+
+    if (frames == 0) {
+        fprintf(stderr, "Gravação da entrada sem quadros: %s\n", path);
+        return false;
+    }
+    frameTimes = malloc((size_t)frames * sizeof(double));
+    if (!frameTimes) return false;
+    frameTimeCapacity = frames;
+
+    mode = INPUT_REPLAYING;
+    nextEvent = 0;
+    frameNumber = 0;
+    measuredFrames = 0;
+    printf("Repetindo %d quadros de %s\n", frames, path);
+    return true;
+}
+
+bool inputReplayActive(void) {
+    return mode == INPUT_REPLAYING;
+}
+
+// Tratadores registrados no GLUT durante a gravação e a repetição
+static void inputKeyboard(unsigned char key, int x, int y) {
+    if (mode == INPUT_RECORDING && key != 27) { // O ESC encerra, não é repetido
+        fprintf(recordFile, "t,%.3f,%d,%d,%d\n", elapsedMs(), key, x, y);
+    } else if (mode == INPUT_REPLAYING && key != 27) {
+        return;
+    }
+    handlers.keyboard(key, x, y);
+}
+
+static void inputMotion(int x, int y) {
+    if (mode == INPUT_REPLAYING) return;
+    fprintf(recordFile, "m,%.3f,%d,%d\n", elapsedMs(), x, y);
+    handlers.motion(x, y);
+}
+
+static void inputButton(int button, int state, int x, int y) {
+    if (mode == INPUT_REPLAYING) return;
+    fprintf(recordFile, "b,%.3f,%d,%d,%d,%d\n", elapsedMs(), button, state, x, y);
+    handlers.button(button, state, x, y);
+}
+
+static void inputEntry(int state) {
+    if (mode == INPUT_REPLAYING) return;
+    fprintf(recordFile, "e,%.3f,%d\n", elapsedMs(), state);
+    handlers.entry(state);
+}
+
+void registerInputHandlers(const InputHandlers* programHandlers) {
+    handlers = *programHandlers;
+    bool wrap = mode != INPUT_IDLE;
+
+    if (handlers.keyboard) glutKeyboardFunc(wrap ? inputKeyboard : handlers.keyboard);
+    if (handlers.motion) {
+        glutMotionFunc(wrap ? inputMotion : handlers.motion);
+        glutPassiveMotionFunc(wrap ? inputMotion : handlers.motion);
+    }
+    if (handlers.button) glutMouseFunc(wrap ? inputButton : handlers.button);
+    if (handlers.entry) glutEntryFunc(wrap ? inputEntry : handlers.entry);
+}
+
+// Entrega um evento gravado ao tratador do programa
+static void dispatchEvent(const InputEvent* event) {
+    switch (event->type) {
+        case 't':
+            if (handlers.keyboard) handlers.keyboard((unsigned char)event->a, event->b, event->c);
+            break;
+        case 'm':
+            if (handlers.motion) handlers.motion(event->a, event->b);
+            break;
+        case 'b':
+            if (handlers.button) handlers.button(event->a, event->b, event->c, event->d);
+            break;
+        case 'e':
+            if (handlers.entry) handlers.entry(event->a);
+            break;
+    }
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Tempos dos quadros repetidos: total, taxa e mínimo, média e p99 por quadro
+static void printReplayReport(void) {
+    int count = measuredFrames;
+    double total = 0.0;
+    for (int i = 0; i < count; i++) total += frameTimes[i];
+
+    printf("Repetição: %d quadros em %.3f s (gravados em %.3f s)", frameNumber,
+           total / 1000.0, recordedMs / 1000.0);
+    if (count > 0) {
+        qsort(frameTimes, (size_t)count, sizeof(double), compareDoubles);
+        int p99 = (count * 99 + 99) / 100 - 1;
+        printf(", %.1f quadros/s, quadro min %.3f / media %.3f / p99 %.3f ms",
+               1000.0 * count / total, frameTimes[0], total / count, frameTimes[p99]);
+    }
+    printf("\n");
+    if (divergedFrame >= 0) {
+        printf("Aviso: o tempo simulado divergiu da gravação a partir do quadro %d\n", divergedFrame);
+    }
+}
+
+bool beginInputFrame(double simulationTime) {
+    if (mode == INPUT_RECORDING) {
+        fprintf(recordFile, "q,%d,%.3f,%.17g\n", frameNumber++, elapsedMs(), simulationTime);
+        return true;
+    }
+    if (mode != INPUT_REPLAYING) return true;
+
+    double now = nowMs();
+    if (frameNumber > 0 && measuredFrames < frameTimeCapacity) {
+        frameTimes[measuredFrames++] = now - lastFrameStart;
+    }
+    lastFrameStart = now;
+
+    // Eventos até a marca deste quadro
+    while (nextEvent < eventCount) {
+        const InputEvent* event = &events[nextEvent++];
+        if (event->type != 'q') {
+            dispatchEvent(event);
+            continue;
+        }
+        double difference = fabs(simulationTime - event->simulationTime);
+        if (divergedFrame < 0 && difference > SIMULATION_TIME_TOLERANCE * fmax(1.0, fabs(event->simulationTime))) {
+            divergedFrame = frameNumber;
+        }
+        frameNumber++;
+        return true;
+    }
+
+    stopInput();
+    return false;
+}
+
+void stopInput(void) {
+    if (mode == INPUT_RECORDING) {
+        fclose(recordFile);
+        recordFile = NULL;
+        printf("Gravação da entrada: %d quadros\n", frameNumber);
+    } else if (mode == INPUT_REPLAYING) {
+        printReplayReport();
+        free(events);
+        free(frameTimes);
+        events = NULL;
+        frameTimes = NULL;
+        eventCount = 0;
+    }
+    mode = INPUT_IDLE;
+}
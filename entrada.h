@@ -0,0 +1,49 @@
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stdbool.h>
+
+// Gravação e repetição da entrada: cada evento de teclado e mouse é gravado em um
+// arquivo texto junto com o quadro em que chegou, e cada quadro com o tempo
+// simulado no seu início. Na repetição os eventos são entregues no começo do mesmo
+// quadro, em vez de quando o GLUT os recebe, e a física avança um passo fixo por
+// quadro: o mesmo voo de câmera gera sempre os mesmos quadros. Ao final sai um
+// relatório com os tempos dos quadros, comparável entre execuções.
+//
+// Formato (uma linha por registro, campos separados por vírgula):
+//   j,largura,altura                  tamanho da janela na gravação
+//   q,quadro,ms,tempo_simulado        início de um quadro
+//   t,ms,tecla,x,y                    tecla
+//   m,ms,x,y                          movimento do mouse
+//   b,ms,botao,estado,x,y             botão do mouse
+//   e,ms,estado                       mouse entrou ou saiu da janela
+// Os eventos antes de uma linha q são entregues antes daquele quadro.
+
+// Funções do programa que tratam a entrada (as que faltarem ficam NULL)
+typedef struct {
+    void (*keyboard)(unsigned char key, int x, int y);
+    void (*motion)(int x, int y);
+    void (*button)(int button, int state, int x, int y);
+    void (*entry)(int state);
+} InputHandlers;
+
+// Começa a gravar a entrada em path, com a janela de width x height
+bool startInputRecording(const char* path, int width, int height);
+
+// Carrega uma gravação e devolve o tamanho da janela usado nela
+bool startInputReplay(const char* path, int* width, int* height);
+
+bool inputReplayActive(void);
+
+// Registra os tratadores no GLUT. Gravando, cada evento é escrito antes de ser
+// tratado; repetindo, a entrada ao vivo é ignorada (exceto ESC).
+void registerInputHandlers(const InputHandlers* handlers);
+
+// Chamar no início de cada quadro, antes de avançar a física. Repetindo, entrega os
+// eventos deste quadro e devolve false quando a gravação acabou.
+bool beginInputFrame(double simulationTime);
+
+// Fecha a gravação ou mostra o relatório da repetição
+void stopInput(void);
+
+#endif
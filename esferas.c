@@ -0,0 +1,436 @@
+#include "esferas.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glext.h>
+
+#include "memoria.h"
+#include "perfil.h"
+
+// Mesma resolução do gluSphere(..., 32, 32) e do gluDisk(..., 32, 1) usados no pipeline fixo
+#define SPHERE_SLICES 32
+#define SPHERE_STACKS 32
+#define RING_SLICES 32
+#define MAX_RING_MESHES 8
+
+// Atributos da malha e das instâncias
+enum {
+    ATTRIB_POSITION = 0,
+    ATTRIB_NORMAL = 1,
+    ATTRIB_TEXCOORD = 2,
+    ATTRIB_MODEL = 3,      // Ocupa 3 a 6 (uma coluna por local)
+    ATTRIB_COLOR_LIT = 7,
+    ATTRIB_LAYER_LOD = 8
+};
+
+// Dados de uma instância, enviados como estão para o buffer de instâncias
+typedef struct {
+    float model[16];
+    float colorLit[4];     // Cor e 1 se iluminada
+    float layerLod[2];     // Camada (-1 sem textura) e menor nível de mipmap permitido
+    GLuint arrayTexture;   // Agrupamento das chamadas (não lido pelo shader)
+    float ringRadius;      // Raio do planeta para os anéis, 0 para esferas
+} SphereInstance;
+
+// Anéis gerados para um raio de planeta (a espessura dos anéis não escala com o raio)
+typedef struct {
+    float planetRadius;
+    GLuint buffer;
+    int vertexCount;
+} RingMesh;
+
+static bool supported = false;
+static GLuint program = 0;
+static GLint viewLocation, projectionLocation, lightingLocation, surfacesLocation;
+static GLuint sphereBuffer = 0, sphereIndexBuffer = 0, instanceBuffer = 0;
+static int sphereIndexCount = 0;
+static size_t instanceBufferBytes = 0; // Contados em MEMORY_MESHES
+static RingMesh ringMeshes[MAX_RING_MESHES];
+static int ringMeshCount = 0;
+
+static SphereInstance* instances = NULL;
+static int instanceCount = 0;
+static int instanceCapacity = 0;
+
+static const char* vertexShaderSource =
+    "#version 130\n"
+    "in vec3 position;\n"
+    "in vec3 normal;\n"
+    "in vec2 texCoord;\n"
+    "in vec4 model0;\n"
+    "in vec4 model1;\n"
+    "in vec4 model2;\n"
+    "in vec4 model3;\n"
+    "in vec4 colorLit;\n"
+    "in vec2 layerLod;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "uniform bool lighting;\n"
+    "out vec4 color;\n"
+    "out vec2 uv;\n"
+    "flat out float layer;\n"
+    "flat out float minLod;\n"
+    "void main() {\n"
+    "    mat4 modelView = view * mat4(model0, model1, model2, model3);\n"
+    "    vec4 eyePos = modelView * vec4(position, 1.0);\n"
+    "    gl_Position = projection * eyePos;\n"
+    "    uv = texCoord;\n"
+    "    layer = layerLod.x;\n"
+    "    minLod = layerLod.y;\n"
+    "    vec4 base = vec4(colorLit.rgb, 1.0);\n"
+    "    if (!lighting || colorLit.w < 0.5) {\n"
+    "        color = base;\n"
+    "        return;\n"
+    "    }\n"
+    // Iluminação por vértice do pipeline fixo: GL_COLOR_MATERIAL em ambiente e difusa,
+    // especular e brilho do material atual, observador no infinito
+    "    vec3 n = normalize(mat3(modelView) * normal);\n"
+    "    vec4 lightPos = gl_LightSource[0].position;\n"
+    "    vec3 l = normalize(lightPos.xyz - eyePos.xyz * lightPos.w);\n"
+    "    float diffuse = max(dot(n, l), 0.0);\n"
+    "    vec4 lit = gl_FrontMaterial.emission + gl_LightModel.ambient * base\n"
+    "             + gl_LightSource[0].ambient * base + diffuse * gl_LightSource[0].diffuse * base;\n"
+    "    if (diffuse > 0.0) {\n"
+    "        vec3 h = normalize(l + vec3(0.0, 0.0, 1.0));\n"
+    "        lit += pow(max(dot(n, h), 0.0), gl_FrontMaterial.shininess)\n"
+    "             * gl_LightSource[0].specular * gl_FrontMaterial.specular;\n"
+    "    }\n"
+    "    color = clamp(lit, 0.0, 1.0);\n"
+    "}\n";
+
+// A textura modula a cor (GL_MODULATE). O nível de mipmap é calculado como o do
+// pipeline fixo, mas sem descer abaixo do mais detalhado já enviado para a camada.
+static const char* fragmentShaderSource =
+    "#version 130\n"
+    "uniform sampler2DArray surfaces;\n"
+    "in vec4 color;\n"
+    "in vec2 uv;\n"
+    "flat in float layer;\n"
+    "flat in float minLod;\n"
+    "void main() {\n"
+    "    vec4 texel = vec4(1.0);\n"
+    "    if (layer >= 0.0) {\n"
+    "        vec2 texels = uv * vec2(textureSize(surfaces, 0).xy);\n"
+    "        vec2 dx = dFdx(texels);\n"
+    "        vec2 dy = dFdy(texels);\n"
+    "        float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));\n"
+    "        texel = textureLod(surfaces, vec3(uv, layer), max(lod, minLod));\n"
+    "    }\n"
+    "    gl_FragColor = color * texel;\n"
+    "}\n";
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint ok;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Erro ao compilar shader das esferas:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Esfera unitária com a mesma parametrização do gluSphere: polos em z, s de 0 a 1
+// começando em +y e girando para -x, t de 0 (polo sul) a 1 (polo norte)
+static void buildSphereMesh(void) {
+    int columns = SPHERE_SLICES + 1;
+    int vertexCount = columns * (SPHERE_STACKS + 1);
+    float* vertices = malloc((size_t)vertexCount * 8 * sizeof(float));
+    GLushort* indices = malloc((size_t)SPHERE_SLICES * SPHERE_STACKS * 6 * sizeof(GLushort));
+    if (!vertices || !indices) {
+        free(vertices);
+        free(indices);
+        return;
+    }
+
+    float* v = vertices;
+    for (int j = 0; j <= SPHERE_STACKS; j++) {
+        float rho = (float)M_PI * j / SPHERE_STACKS;
+        for (int i = 0; i <= SPHERE_SLICES; i++) {
+            float theta = 2.0f * (float)M_PI * i / SPHERE_SLICES;
+            float x = -sinf(theta) * sinf(rho);
+            float y = cosf(theta) * sinf(rho);
+            float z = cosf(rho);
+            *v++ = x; *v++ = y; *v++ = z;   // Posição
+            *v++ = x; *v++ = y; *v++ = z;   // Normal
+            *v++ = (float)i / SPHERE_SLICES;
+            *v++ = 1.0f - (float)j / SPHERE_STACKS;
+        }
+    }
+
+    GLushort* index = indices;
+    for (int j = 0; j < SPHERE_STACKS; j++) {
+        for (int i = 0; i < SPHERE_SLICES; i++) {
+            GLushort a = (GLushort)(j * columns + i);
+            GLushort b = (GLushort)((j + 1) * columns + i);
+            *index++ = a; *index++ = b; *index++ = (GLushort)(a + 1);
+            *index++ = (GLushort)(a + 1); *index++ = b; *index++ = (GLushort)(b + 1);
+        }
+    }
+    sphereIndexCount = SPHERE_SLICES * SPHERE_STACKS * 6;
+
+    glGenBuffers(1, &sphereBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, sphereBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * 8 * sizeof(float), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &sphereIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)sphereIndexCount * sizeof(GLushort), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    trackMemory(MEMORY_MESHES, (long long)vertexCount * 8 * sizeof(float) + sphereIndexCount * sizeof(GLushort));
+    free(vertices);
+    free(indices);
+}
+
+// Um disco como o gluDisk: coordenadas de textura 0.5 + x / (2 * raio externo)
+static float* appendDisk(float* v, float innerRadius, float outerRadius) {
+    for (int i = 0; i < RING_SLICES; i++) {
+        float a0 = 2.0f * (float)M_PI * i / RING_SLICES;
+        float a1 = 2.0f * (float)M_PI * (i + 1) / RING_SLICES;
+        float corners[4][2] = {
+            { innerRadius * sinf(a0), innerRadius * cosf(a0) },
+            { outerRadius * sinf(a0), outerRadius * cosf(a0) },
+            { innerRadius * sinf(a1), innerRadius * cosf(a1) },
+            { outerRadius * sinf(a1), outerRadius * cosf(a1) }
+        };
+        static const int order[6] = { 0, 1, 2, 2, 1, 3 };
+        for (int k = 0; k < 6; k++) {
+            float x = corners[order[k]][0];
+            float y = corners[order[k]][1];
+            *v++ = x; *v++ = y; *v++ = 0.0f;
+            *v++ = 0.0f; *v++ = 0.0f; *v++ = 1.0f;
+            *v++ = 0.5f + x / (2.0f * outerRadius);
+            *v++ = 0.5f + y / (2.0f * outerRadius);
+        }
+    }
+    return v;
+}
+
+// Os mesmos sete discos do desenho dos anéis de Saturno no pipeline fixo
+static RingMesh* findRingMesh(float planetRadius) {
+    for (int i = 0; i < ringMeshCount; i++) {
+        if (ringMeshes[i].planetRadius == planetRadius) return &ringMeshes[i];
+    }
+    if (ringMeshCount == MAX_RING_MESHES) return NULL;
+
+    int vertexCount = 7 * RING_SLICES * 6;
+    float* vertices = malloc((size_t)vertexCount * 8 * sizeof(float));
+    if (!vertices) return NULL;
+
+    float innerRadius = planetRadius * 1.2f;
+    float outerRadius = planetRadius * 2.0f;
+    float ringThickness = 0.05f;
+    float* v = appendDisk(vertices, innerRadius + ringThickness * 2, innerRadius + ringThickness * 3);
+    float spacing = (outerRadius - (innerRadius + ringThickness * 3)) / 6.0f;
+    for (int j = 0; j < 5; j++) {
+        float currentRadius = innerRadius + ringThickness * 3 + spacing * (j + 1);
+        v = appendDisk(v, currentRadius, currentRadius + ringThickness);
+    }
+    appendDisk(v, outerRadius - ringThickness, outerRadius);
+
+    RingMesh* mesh = &ringMeshes[ringMeshCount++];
+    mesh->planetRadius = planetRadius;
+    mesh->vertexCount = vertexCount;
+    glGenBuffers(1, &mesh->buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * 8 * sizeof(float), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    trackMemory(MEMORY_MESHES, (long long)vertexCount * 8 * sizeof(float));
+    free(vertices);
+    return mesh;
+}
+
+bool initSphereRenderer(void) {
+    int major = 0, minor = 0;
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2 || major < 3 || (major == 3 && minor < 3)) {
+        fprintf(stderr, "Esferas instanciadas desativadas: OpenGL 3.3 não disponível\n");
+        return false;
+    }
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    if (!vs || !fs) return false;
+
+    program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glBindAttribLocation(program, ATTRIB_POSITION, "position");
+    glBindAttribLocation(program, ATTRIB_NORMAL, "normal");
+    glBindAttribLocation(program, ATTRIB_TEXCOORD, "texCoord");
+    glBindAttribLocation(program, ATTRIB_MODEL + 0, "model0");
+    glBindAttribLocation(program, ATTRIB_MODEL + 1, "model1");
+    glBindAttribLocation(program, ATTRIB_MODEL + 2, "model2");
+    glBindAttribLocation(program, ATTRIB_MODEL + 3, "model3");
+    glBindAttribLocation(program, ATTRIB_COLOR_LIT, "colorLit");
+    glBindAttribLocation(program, ATTRIB_LAYER_LOD, "layerLod");
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Erro ao ligar shader das esferas:\n%s\n", log);
+        glDeleteProgram(program);
+        program = 0;
+        return false;
+    }
+    viewLocation = glGetUniformLocation(program, "view");
+    projectionLocation = glGetUniformLocation(program, "projection");
+    lightingLocation = glGetUniformLocation(program, "lighting");
+    surfacesLocation = glGetUniformLocation(program, "surfaces");
+
+    buildSphereMesh();
+    glGenBuffers(1, &instanceBuffer);
+    supported = sphereIndexCount > 0;
+    return supported;
+}
+
+void beginSphereBatch(void) {
+    instanceCount = 0;
+}
+
+static SphereInstance* newInstance(const Mat4* model, const float color[3], bool lit,
+                                   GLuint arrayTexture, int layer, float minLod) {
+    if (instanceCount == instanceCapacity) {
+        int newCapacity = instanceCapacity ? instanceCapacity * 2 : 64;
+        SphereInstance* newList = realloc(instances, newCapacity * sizeof(SphereInstance));
+        if (!newList) return NULL;
+        instances = newList;
+        instanceCapacity = newCapacity;
+    }
+    SphereInstance* instance = &instances[instanceCount++];
+    memcpy(instance->model, model->m, sizeof(instance->model));
+    instance->colorLit[0] = color[0];
+    instance->colorLit[1] = color[1];
+    instance->colorLit[2] = color[2];
+    instance->colorLit[3] = lit ? 1.0f : 0.0f;
+    instance->layerLod[0] = layer >= 0 ? (float)layer : -1.0f;
+    instance->layerLod[1] = minLod;
+    instance->arrayTexture = layer >= 0 ? arrayTexture : 0;
+    instance->ringRadius = 0.0f;
+    return instance;
+}
+
+void addSphereInstance(const Mat4* model, float radius, const float color[3], bool lit,
+                       GLuint arrayTexture, int layer, float minLod) {
+    SphereInstance* instance = newInstance(model, color, lit, arrayTexture, layer, minLod);
+    if (!instance) return;
+    // A malha tem raio 1: escalar as três primeiras colunas
+    for (int i = 0; i < 12; i++) {
+        instance->model[i] *= radius;
+    }
+}
+
+void addRingInstance(const Mat4* model, float planetRadius, const float color[3],
+                     GLuint arrayTexture, int layer, float minLod) {
+    SphereInstance* instance = newInstance(model, color, false, arrayTexture, layer, minLod);
+    if (instance) instance->ringRadius = planetRadius;
+}
+
+// Esferas primeiro, agrupadas por array de texturas; anéis no fim
+static int compareInstances(const void* a, const void* b) {
+    const SphereInstance* ia = a;
+    const SphereInstance* ib = b;
+    bool ringA = ia->ringRadius > 0.0f, ringB = ib->ringRadius > 0.0f;
+    if (ringA != ringB) return ringA - ringB;
+    return (ia->arrayTexture > ib->arrayTexture) - (ia->arrayTexture < ib->arrayTexture);
+}
+
+static void setMeshPointers(GLuint buffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)0);
+    glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(3 * sizeof(float)));
+    glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (const void*)(6 * sizeof(float)));
+}
+
+// Aponta os atributos por instância para o registro first do buffer de instâncias
+static void setInstancePointers(int first) {
+    size_t base = (size_t)first * sizeof(SphereInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int c = 0; c < 4; c++) {
+        glVertexAttribPointer(ATTRIB_MODEL + c, 4, GL_FLOAT, GL_FALSE, sizeof(SphereInstance),
+                              (const void*)(base + offsetof(SphereInstance, model) + c * 4 * sizeof(float)));
+    }
+    glVertexAttribPointer(ATTRIB_COLOR_LIT, 4, GL_FLOAT, GL_FALSE, sizeof(SphereInstance),
+                          (const void*)(base + offsetof(SphereInstance, colorLit)));
+    glVertexAttribPointer(ATTRIB_LAYER_LOD, 2, GL_FLOAT, GL_FALSE, sizeof(SphereInstance),
+                          (const void*)(base + offsetof(SphereInstance, layerLod)));
+}
+
+void drawSphereBatch(const Mat4* view, const Mat4* projection, bool lighting) {
+    if (!supported || instanceCount == 0) return;
+
+    // Esferas sem textura entram no grupo de qualquer array, para não gerar outra chamada
+    GLuint anyArray = 0;
+    for (int i = 0; i < instanceCount && !anyArray; i++) {
+        anyArray = instances[i].arrayTexture;
+    }
+    for (int i = 0; i < instanceCount; i++) {
+        if (instances[i].layerLod[0] < 0.0f) instances[i].arrayTexture = anyArray;
+    }
+    qsort(instances, instanceCount, sizeof(SphereInstance), compareInstances);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)instanceCount * sizeof(SphereInstance), NULL, GL_STREAM_DRAW);
+    trackMemorySize(MEMORY_MESHES, &instanceBufferBytes, (size_t)instanceCount * sizeof(SphereInstance));
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)instanceCount * sizeof(SphereInstance), instances);
+
+    glUseProgram(program);
+    glUniformMatrix4fv(viewLocation, 1, GL_FALSE, view->m);
+    glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, projection->m);
+    glUniform1i(lightingLocation, lighting);
+    glUniform1i(surfacesLocation, 0);
+
+    for (int a = ATTRIB_POSITION; a <= ATTRIB_LAYER_LOD; a++) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, a >= ATTRIB_MODEL ? 1 : 0);
+    }
+
+    // Esferas: uma chamada por array de texturas
+    setMeshPointers(sphereBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereIndexBuffer);
+    int first = 0;
+    while (first < instanceCount && instances[first].ringRadius == 0.0f) {
+        int last = first;
+        while (last < instanceCount && instances[last].ringRadius == 0.0f
+               && instances[last].arrayTexture == instances[first].arrayTexture) {
+            last++;
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, instances[first].arrayTexture);
+        setInstancePointers(first);
+        glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_SHORT, (const void*)0, last - first);
+        first = last;
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Anéis: uma instância cada, com a malha do raio do planeta
+    profileBegin(PHASE_RINGS);
+    for (; first < instanceCount; first++) {
+        RingMesh* mesh = findRingMesh(instances[first].ringRadius);
+        if (!mesh) continue;
+        setMeshPointers(mesh->buffer);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, instances[first].arrayTexture);
+        setInstancePointers(first);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, mesh->vertexCount, 1);
+    }
+    profileEnd(PHASE_RINGS);
+
+    for (int a = ATTRIB_POSITION; a <= ATTRIB_LAYER_LOD; a++) {
+        glVertexAttribDivisor(a, 0);
+        glDisableVertexAttribArray(a);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
@@ -0,0 +1,35 @@
+#ifndef ESFERAS_H
+#define ESFERAS_H
+
+#include <stdbool.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+
+#include "matematica.h"
+
+// Desenho instanciado dos corpos com textura em array: uma malha de esfera comum a
+// todos e um registro por corpo (matriz de modelo, cor, camada da textura). Todas as
+// esferas que usam o mesmo array de texturas saem em uma única chamada de desenho.
+// A iluminação do shader reproduz a do pipeline fixo (GL_LIGHT0 e o material atual).
+
+// Compila o shader e cria as malhas. Retorna false se o OpenGL não tiver suporte
+// (versão 3.3 ou superior); nesse caso os corpos devem usar o pipeline fixo.
+bool initSphereRenderer(void);
+
+// Começa um novo lote de instâncias para o quadro
+void beginSphereBatch(void);
+
+// Adiciona uma esfera de raio radius. layer < 0 desenha só com a cor.
+// Sem iluminação (lit = false), a cor é usada diretamente, como no Sol.
+void addSphereInstance(const Mat4* model, float radius, const float color[3], bool lit,
+                       GLuint arrayTexture, int layer, float minLod);
+
+// Adiciona os anéis de um planeta de raio planetRadius (sempre sem iluminação)
+void addRingInstance(const Mat4* model, float planetRadius, const float color[3],
+                     GLuint arrayTexture, int layer, float minLod);
+
+// Desenha o lote: uma chamada instanciada por array de texturas, mais uma por anel
+void drawSphereBatch(const Mat4* view, const Mat4* projection, bool lighting);
+
+#endif
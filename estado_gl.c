@@ -0,0 +1,109 @@
+#include "estado_gl.h"
+#include <string.h>
+
+// Último valor enviado de cada estado com cache
+typedef struct {
+    bool lighting;
+    bool light0;
+    bool texture2D;
+    GLuint boundTexture;
+    GLint textureEnvMode;
+    GLfloat emission[4];
+    GLfloat color[3];
+} ShadowState;
+
+// Se o valor em shadow é confiável (false força a próxima chamada a ser enviada)
+static struct {
+    bool lighting, light0, texture2D, boundTexture, textureEnvMode, emission, color;
+} valid;
+
+static ShadowState shadow;
+static RenderStateStats stats;
+
+void invalidateRenderState(void) {
+    memset(&valid, 0, sizeof(valid));
+}
+
+static void applyCapability(GLenum capability, bool enabled) {
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void setCapability(GLenum capability, bool enabled) {
+    bool* cached;
+    bool* cachedValid;
+    switch (capability) {
+        case GL_LIGHTING:   cached = &shadow.lighting;  cachedValid = &valid.lighting;  break;
+        case GL_LIGHT0:     cached = &shadow.light0;    cachedValid = &valid.light0;    break;
+        case GL_TEXTURE_2D: cached = &shadow.texture2D; cachedValid = &valid.texture2D; break;
+        default:
+            applyCapability(capability, enabled);
+            stats.issued++;
+            return;
+    }
+
+    if (*cachedValid && *cached == enabled) {
+        stats.skipped++;
+        return;
+    }
+    applyCapability(capability, enabled);
+    *cached = enabled;
+    *cachedValid = true;
+    stats.issued++;
+}
+
+void bindTexture2D(GLuint texture) {
+    if (valid.boundTexture && shadow.boundTexture == texture) {
+        stats.skipped++;
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    shadow.boundTexture = texture;
+    valid.boundTexture = true;
+    stats.issued++;
+}
+
+void setTextureEnvMode(GLint mode) {
+    if (valid.textureEnvMode && shadow.textureEnvMode == mode) {
+        stats.skipped++;
+        return;
+    }
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode);
+    shadow.textureEnvMode = mode;
+    valid.textureEnvMode = true;
+    stats.issued++;
+}
+
+void setMaterialEmission(const GLfloat emission[4]) {
+    if (valid.emission && memcmp(shadow.emission, emission, sizeof(shadow.emission)) == 0) {
+        stats.skipped++;
+        return;
+    }
+    glMaterialfv(GL_FRONT, GL_EMISSION, emission);
+    memcpy(shadow.emission, emission, sizeof(shadow.emission));
+    valid.emission = true;
+    stats.issued++;
+}
+
+void setColor(GLfloat r, GLfloat g, GLfloat b) {
+    if (valid.color && shadow.color[0] == r && shadow.color[1] == g && shadow.color[2] == b) {
+        stats.skipped++;
+        return;
+    }
+    glColor3f(r, g, b);
+    shadow.color[0] = r;
+    shadow.color[1] = g;
+    shadow.color[2] = b;
+    valid.color = true;
+    stats.issued++;
+}
+
+RenderStateStats beginRenderStateFrame(void) {
+    RenderStateStats previous = stats;
+    stats.issued = 0;
+    stats.skipped = 0;
+    return previous;
+}
@@ -0,0 +1,40 @@
+#ifndef ESTADO_GL_H
+#define ESTADO_GL_H
+
+#include <stdbool.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+
+// Cópia na CPU de parte do estado do OpenGL: cada chamada só chega ao driver quando
+// o valor muda. Código que altera estes estados diretamente (sem passar por aqui)
+// deve chamar invalidateRenderState() em seguida.
+
+// Chamadas de estado de um quadro: enviadas ao driver e evitadas por serem redundantes
+typedef struct {
+    int issued;
+    int skipped;
+} RenderStateStats;
+
+// Esquece todo o estado conhecido; as próximas chamadas serão sempre enviadas
+void invalidateRenderState(void);
+
+// Liga ou desliga GL_LIGHTING, GL_LIGHT0 ou GL_TEXTURE_2D (outros vão direto ao driver)
+void setCapability(GLenum capability, bool enabled);
+
+// glBindTexture(GL_TEXTURE_2D, texture)
+void bindTexture2D(GLuint texture);
+
+// glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode)
+void setTextureEnvMode(GLint mode);
+
+// glMaterialfv(GL_FRONT, GL_EMISSION, emission)
+void setMaterialEmission(const GLfloat emission[4]);
+
+// glColor3f(r, g, b)
+void setColor(GLfloat r, GLfloat g, GLfloat b);
+
+// Zera os contadores no início do quadro e devolve os do quadro anterior
+RenderStateStats beginRenderStateFrame(void);
+
+#endif
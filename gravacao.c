@@ -0,0 +1,517 @@
+#include "gravacao.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include "rastro.h"
+
+#define RECORDING_PBO_COUNT 3
+#define MAX_RECORDING_THREADS 8
+#define RECORDING_PATH_LENGTH 1024
+
+// Taxa de quadros escrita no cabeçalho do Y4M
+#define RECORDING_FPS 60
+
+// Um quadro na fila: pixels RGBA com as linhas de baixo para cima, como o OpenGL entrega
+typedef struct {
+    unsigned char* pixels;
+    int number;
+} RecordedFrame;
+
+static bool active = false;
+static RecordingFormat recordFormat;
+static char recordDir[RECORDING_PATH_LENGTH];
+static int recordWidth;
+static int recordHeight;
+static size_t frameSize;
+
+// Leituras em rodízio: o quadro N é lido para pixelBuffers[N % 3] e copiado para a
+// fila depois que os quadros N + 1 e N + 2 já foram pedidos
+static GLuint pixelBuffers[RECORDING_PBO_COUNT];
+static int framesIssued = 0;
+static int framesRetrieved = 0;
+
+// Fila limitada: cada slot tem memória para um quadro inteiro e passa de livre
+// (freeSlots) para pronto (readySlots) e de volta
+static RecordedFrame* slots = NULL;
+static int slotCount = 0;
+static RecordedFrame** freeSlots = NULL;
+static int freeCount = 0;
+static RecordedFrame** readySlots = NULL;
+static int readyHead = 0;
+static int readyCount = 0;
+static bool finishing = false;
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slotFreed = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t frameQueued = PTHREAD_COND_INITIALIZER;
+
+static pthread_t threads[MAX_RECORDING_THREADS];
+static int threadCount = 0;
+
+// Vídeo Y4M: as threads convertem em paralelo, mas escrevem na ordem dos quadros
+static FILE* videoFile = NULL;
+static int nextVideoFrame = 0;
+static pthread_mutex_t videoLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t videoTurn = PTHREAD_COND_INITIALIZER;
+
+static atomic_bool writeFailed;
+static double queueWaitMs = 0.0; // Tempo que o desenho passou esperando slot livre
+static struct timespec recordStart;
+
+static double elapsedMs(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1.0e6;
+}
+
+bool parseRecordingFormat(const char* name, RecordingFormat* format) {
+    if (strcmp(name, "png") == 0) {
+        *format = RECORDING_PNG;
+    } else if (strcmp(name, "y4m") == 0) {
+        *format = RECORDING_Y4M;
+    } else if (strcmp(name, "ppm") == 0) {
+        *format = RECORDING_PPM;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool recordingActive(void) {
+    return active;
+}
+
+// Avisa só da primeira falha de escrita; os quadros seguintes continuam saindo da fila
+static void reportWriteFailure(const char* filename) {
+    if (!atomic_exchange(&writeFailed, true)) {
+        fprintf(stderr, "Falha ao gravar quadro: %s\n", filename);
+    }
+}
+
+static RecordedFrame* acquireSlot(void) {
+    pthread_mutex_lock(&queueLock);
+    if (freeCount == 0) {
+        // Fila cheia: esperar as threads em vez de descartar o quadro
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (freeCount == 0) {
+            pthread_cond_wait(&slotFreed, &queueLock);
+        }
+        queueWaitMs += elapsedMs(&start);
+    }
+    RecordedFrame* slot = freeSlots[--freeCount];
+    pthread_mutex_unlock(&queueLock);
+    return slot;
+}
+
+static void queueFrame(RecordedFrame* slot) {
+    pthread_mutex_lock(&queueLock);
+    readySlots[(readyHead + readyCount) % slotCount] = slot;
+    readyCount++;
+    pthread_cond_signal(&frameQueued);
+    pthread_mutex_unlock(&queueLock);
+}
+
+// Próximo quadro da fila, NULL quando a gravação terminou e a fila esvaziou
+static RecordedFrame* takeFrame(void) {
+    pthread_mutex_lock(&queueLock);
+    while (readyCount == 0 && !finishing) {
+        pthread_cond_wait(&frameQueued, &queueLock);
+    }
+    RecordedFrame* slot = NULL;
+    if (readyCount > 0) {
+        slot = readySlots[readyHead];
+        readyHead = (readyHead + 1) % slotCount;
+        readyCount--;
+    }
+    pthread_mutex_unlock(&queueLock);
+    return slot;
+}
+
+static void releaseSlot(RecordedFrame* slot) {
+    pthread_mutex_lock(&queueLock);
+    freeSlots[freeCount++] = slot;
+    pthread_cond_signal(&slotFreed);
+    pthread_mutex_unlock(&queueLock);
+}
+
+static void putBigEndian32(unsigned char* out, uint32_t value) {
+    out[0] = (unsigned char)(value >> 24);
+    out[1] = (unsigned char)(value >> 16);
+    out[2] = (unsigned char)(value >> 8);
+    out[3] = (unsigned char)value;
+}
+
+static bool writePngChunk(FILE* file, const char* type, const unsigned char* data, uint32_t length) {
+    unsigned char header[8];
+    putBigEndian32(header, length);
+    memcpy(header + 4, type, 4);
+    uLong crc = crc32(0L, header + 4, 4);
+    if (length > 0) crc = crc32(crc, data, length);
+    unsigned char footer[4];
+    putBigEndian32(footer, (uint32_t)crc);
+    return fwrite(header, 1, 8, file) == 8 &&
+           (length == 0 || fwrite(data, 1, length, file) == length) &&
+           fwrite(footer, 1, 4, file) == 4;
+}
+
+// PNG RGB de 8 bits: linhas com o filtro Sub (barato e bom para o fundo preto)
+// comprimidas no nível mais rápido do zlib
+static void encodePng(RecordedFrame* frame, unsigned char* filtered, unsigned char* compressed,
+                      uLong compressedCapacity) {
+    int width = recordWidth;
+    int height = recordHeight;
+    size_t rowSize = 1 + (size_t)width * 3;
+    for (int y = 0; y < height; y++) {
+        const unsigned char* src = frame->pixels + (size_t)(height - 1 - y) * width * 4;
+        unsigned char* dst = filtered + (size_t)y * rowSize;
+        dst[0] = 1; // Sub
+        unsigned char left[3] = { 0, 0, 0 };
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 3; c++) {
+                unsigned char value = src[x * 4 + c];
+                dst[1 + x * 3 + c] = (unsigned char)(value - left[c]);
+                left[c] = value;
+            }
+        }
+    }
+    int number = frame->number;
+    releaseSlot(frame);
+
+    uLongf compressedSize = compressedCapacity;
+    char filename[RECORDING_PATH_LENGTH + 32];
+    snprintf(filename, sizeof(filename), "%s/quadro_%05d.png", recordDir, number);
+    if (compress2(compressed, &compressedSize, filtered, (uLong)(rowSize * height), Z_BEST_SPEED) != Z_OK) {
+        reportWriteFailure(filename);
+        return;
+    }
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        reportWriteFailure(filename);
+        return;
+    }
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    unsigned char header[13];
+    putBigEndian32(header, (uint32_t)width);
+    putBigEndian32(header + 4, (uint32_t)height);
+    header[8] = 8;  // Bits por canal
+    header[9] = 2;  // RGB
+    header[10] = 0; // Deflate
+    header[11] = 0; // Filtros adaptativos
+    header[12] = 0; // Sem entrelaçamento
+    bool ok = fwrite(signature, 1, 8, file) == 8 &&
+              writePngChunk(file, "IHDR", header, 13) &&
+              writePngChunk(file, "IDAT", compressed, (uint32_t)compressedSize) &&
+              writePngChunk(file, "IEND", NULL, 0);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) reportWriteFailure(filename);
+}
+
+static void encodePpm(RecordedFrame* frame, unsigned char* rgb) {
+    int width = recordWidth;
+    int height = recordHeight;
+    for (int y = 0; y < height; y++) {
+        const unsigned char* src = frame->pixels + (size_t)(height - 1 - y) * width * 4;
+        unsigned char* dst = rgb + (size_t)y * width * 3;
+        for (int x = 0; x < width; x++) {
+            dst[x * 3] = src[x * 4];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+    int number = frame->number;
+    releaseSlot(frame);
+
+    char filename[RECORDING_PATH_LENGTH + 32];
+    snprintf(filename, sizeof(filename), "%s/quadro_%05d.ppm", recordDir, number);
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        reportWriteFailure(filename);
+        return;
+    }
+    size_t size = (size_t)width * height * 3;
+    bool ok = fprintf(file, "P6\n%d %d\n255\n", width, height) > 0 && fwrite(rgb, 1, size, file) == size;
+    if (fclose(file) != 0) ok = false;
+    if (!ok) reportWriteFailure(filename);
+}
+
+// Y4M 4:2:0 com as cores do BT.601 em faixa limitada; o croma é a média de cada 2x2
+static void encodeY4m(RecordedFrame* frame, unsigned char* yuv) {
+    int width = recordWidth;
+    int height = recordHeight;
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    unsigned char* planeY = yuv;
+    unsigned char* planeU = planeY + (size_t)width * height;
+    unsigned char* planeV = planeU + (size_t)chromaWidth * chromaHeight;
+
+    for (int y = 0; y < height; y++) {
+        const unsigned char* src = frame->pixels + (size_t)(height - 1 - y) * width * 4;
+        unsigned char* dst = planeY + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int r = src[x * 4], g = src[x * 4 + 1], b = src[x * 4 + 2];
+            dst[x] = (unsigned char)(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                int y = cy * 2 + dy;
+                if (y >= height) break;
+                const unsigned char* src = frame->pixels + (size_t)(height - 1 - y) * width * 4;
+                for (int dx = 0; dx < 2; dx++) {
+                    int x = cx * 2 + dx;
+                    if (x >= width) break;
+                    r += src[x * 4];
+                    g += src[x * 4 + 1];
+                    b += src[x * 4 + 2];
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            size_t i = (size_t)cy * chromaWidth + cx;
+            planeU[i] = (unsigned char)(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+            planeV[i] = (unsigned char)(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+        }
+    }
+    int number = frame->number;
+    releaseSlot(frame);
+
+    // Esperar a vez deste quadro no arquivo
+    size_t size = (size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight;
+    pthread_mutex_lock(&videoLock);
+    while (nextVideoFrame != number) {
+        pthread_cond_wait(&videoTurn, &videoLock);
+    }
+    if (fputs("FRAME\n", videoFile) == EOF || fwrite(yuv, 1, size, videoFile) != size) {
+        reportWriteFailure("video.y4m");
+    }
+    nextVideoFrame++;
+    pthread_cond_broadcast(&videoTurn);
+    pthread_mutex_unlock(&videoLock);
+}
+
+static void* recordingWorker(void* unused) {
+    (void)unused;
+    size_t pixelCount = (size_t)recordWidth * recordHeight;
+
+    // Memória de trabalho própria de cada thread
+    unsigned char* scratch = NULL;
+    unsigned char* compressed = NULL;
+    uLong compressedCapacity = 0;
+    if (recordFormat == RECORDING_PNG) {
+        uLong filteredSize = (uLong)((1 + (size_t)recordWidth * 3) * recordHeight);
+        compressedCapacity = compressBound(filteredSize);
+        scratch = malloc(filteredSize);
+        compressed = malloc(compressedCapacity);
+    } else if (recordFormat == RECORDING_Y4M) {
+        scratch = malloc(pixelCount + 2 * (size_t)((recordWidth + 1) / 2) * ((recordHeight + 1) / 2));
+    } else {
+        scratch = malloc(pixelCount * 3);
+    }
+    bool ok = scratch && (recordFormat != RECORDING_PNG || compressed);
+    if (!ok) reportWriteFailure("(sem memória)");
+    traceThreadName("gravação");
+
+    RecordedFrame* frame;
+    while ((frame = takeFrame()) != NULL) {
+        if (!ok) {
+            // Sem memória: só liberar a fila (e a vez no vídeo) para o desenho não travar
+            int number = frame->number;
+            releaseSlot(frame);
+            if (recordFormat == RECORDING_Y4M) {
+                pthread_mutex_lock(&videoLock);
+                while (nextVideoFrame != number) pthread_cond_wait(&videoTurn, &videoLock);
+                nextVideoFrame++;
+                pthread_cond_broadcast(&videoTurn);
+                pthread_mutex_unlock(&videoLock);
+            }
+        } else if (recordFormat == RECORDING_PNG) {
+            traceBegin("codificar png");
+            encodePng(frame, scratch, compressed, compressedCapacity);
+            traceEnd();
+        } else if (recordFormat == RECORDING_Y4M) {
+            traceBegin("codificar y4m");
+            encodeY4m(frame, scratch);
+            traceEnd();
+        } else {
+            traceBegin("codificar ppm");
+            encodePpm(frame, scratch);
+            traceEnd();
+        }
+    }
+
+    free(scratch);
+    free(compressed);
+    return NULL;
+}
+
+static void freeQueue(void) {
+    if (slots) {
+        for (int i = 0; i < slotCount; i++) free(slots[i].pixels);
+    }
+    free(slots);
+    free(freeSlots);
+    free(readySlots);
+    slots = NULL;
+    freeSlots = NULL;
+    readySlots = NULL;
+    slotCount = 0;
+}
+
+bool startRecording(const char* outputDir, RecordingFormat format, int width, int height) {
+    if (active || width <= 0 || height <= 0) return false;
+
+    if (mkdir(outputDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Falha ao criar pasta de saída: %s\n", outputDir);
+        return false;
+    }
+    snprintf(recordDir, sizeof(recordDir), "%s", outputDir);
+    recordFormat = format;
+    recordWidth = width;
+    recordHeight = height;
+    frameSize = (size_t)width * height * 4;
+
+    // Uma thread por núcleo; a fila guarda dois quadros por thread
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threadCount = cores > 0 ? (int)cores : 1;
+    if (threadCount > MAX_RECORDING_THREADS) threadCount = MAX_RECORDING_THREADS;
+    slotCount = threadCount * 2 < 4 ? 4 : threadCount * 2;
+
+    slots = calloc((size_t)slotCount, sizeof(RecordedFrame));
+    freeSlots = malloc((size_t)slotCount * sizeof(RecordedFrame*));
+    readySlots = malloc((size_t)slotCount * sizeof(RecordedFrame*));
+    bool ok = slots && freeSlots && readySlots;
+    for (int i = 0; ok && i < slotCount; i++) {
+        slots[i].pixels = malloc(frameSize);
+        ok = slots[i].pixels != NULL;
+        freeSlots[i] = &slots[i];
+    }
+    if (!ok) {
+        fprintf(stderr, "Erro: Falha ao alocar memória para a gravação.\n");
+        freeQueue();
+        return false;
+    }
+    freeCount = slotCount;
+    readyHead = 0;
+    readyCount = 0;
+    finishing = false;
+
+    if (format == RECORDING_Y4M) {
+        char filename[RECORDING_PATH_LENGTH + 32];
+        snprintf(filename, sizeof(filename), "%s/video.y4m", recordDir);
+        videoFile = fopen(filename, "wb");
+        if (!videoFile) {
+            fprintf(stderr, "Falha ao criar vídeo: %s\n", filename);
+            freeQueue();
+            return false;
+        }
+        fprintf(videoFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, RECORDING_FPS);
+        nextVideoFrame = 0;
+    }
+
+    glGenBuffers(RECORDING_PBO_COUNT, pixelBuffers);
+    for (int i = 0; i < RECORDING_PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)frameSize, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    framesIssued = 0;
+    framesRetrieved = 0;
+    queueWaitMs = 0.0;
+    atomic_store(&writeFailed, false);
+
+    int started = 0;
+    for (int t = 0; t < threadCount; t++) {
+        if (pthread_create(&threads[started], NULL, recordingWorker, NULL) == 0) started++;
+    }
+    threadCount = started;
+    if (threadCount == 0) {
+        fprintf(stderr, "Erro: Falha ao criar threads de gravação.\n");
+        glDeleteBuffers(RECORDING_PBO_COUNT, pixelBuffers);
+        if (videoFile) fclose(videoFile);
+        videoFile = NULL;
+        freeQueue();
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &recordStart);
+    active = true;
+    printf("Gravação iniciada: %dx%d em %s/\n", width, height, recordDir);
+    return true;
+}
+
+// Copia para a fila o quadro lido há mais tempo. O mapeamento só espera a GPU se
+// a leitura ainda não terminou, o que com três buffers quase nunca acontece.
+static void retrieveFrame(void) {
+    RecordedFrame* slot = acquireSlot();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[framesRetrieved % RECORDING_PBO_COUNT]);
+    const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data) {
+        memcpy(slot->pixels, data, frameSize);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        memset(slot->pixels, 0, frameSize);
+    }
+    slot->number = framesRetrieved++;
+    queueFrame(slot);
+}
+
+void captureFrame(void) {
+    if (!active) return;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[framesIssued % RECORDING_PBO_COUNT]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, recordWidth, recordHeight, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    framesIssued++;
+
+    if (framesIssued - framesRetrieved == RECORDING_PBO_COUNT) {
+        retrieveFrame();
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void stopRecording(void) {
+    if (!active) return;
+
+    while (framesRetrieved < framesIssued) {
+        retrieveFrame();
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pthread_mutex_lock(&queueLock);
+    finishing = true;
+    pthread_cond_broadcast(&frameQueued);
+    pthread_mutex_unlock(&queueLock);
+    for (int t = 0; t < threadCount; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    if (videoFile && fclose(videoFile) != 0) {
+        reportWriteFailure("video.y4m");
+    }
+    videoFile = NULL;
+    glDeleteBuffers(RECORDING_PBO_COUNT, pixelBuffers);
+    freeQueue();
+    active = false;
+
+    printf("Gravação: %d quadros em %s/ em %.1f ms (%.1f ms esperando a fila)%s\n",
+           framesRetrieved, recordDir, elapsedMs(&recordStart), queueWaitMs,
+           atomic_load(&writeFailed) ? ", com erros" : "");
+}
@@ -0,0 +1,33 @@
+#ifndef GRAVACAO_H
+#define GRAVACAO_H
+
+#include <stdbool.h>
+
+// Gravação de quadros: a imagem de cada quadro é lida para um de três buffers de
+// pixels (PBOs) em rodízio, sem esperar a GPU terminar, e só copiada dois quadros
+// depois para uma fila limitada. Threads tiram os quadros da fila e os codificam em
+// PNG ou PPM (um arquivo por quadro) ou em um único vídeo Y4M. Com a fila cheia o
+// desenho espera as threads: nenhum quadro é descartado.
+
+typedef enum {
+    RECORDING_PNG,
+    RECORDING_Y4M,
+    RECORDING_PPM
+} RecordingFormat;
+
+// Interpreta "png", "y4m" ou "ppm"
+bool parseRecordingFormat(const char* name, RecordingFormat* format);
+
+// Começa a gravar quadros de width x height na pasta dada: quadro_NNNNN.png/.ppm
+// ou video.y4m. Chamar com o contexto OpenGL atual.
+bool startRecording(const char* outputDir, RecordingFormat format, int width, int height);
+
+bool recordingActive(void);
+
+// Lê o quadro recém-desenhado. Chamar depois de desenhar e antes de trocar os buffers.
+void captureFrame(void);
+
+// Busca as leituras pendentes, espera as threads codificarem tudo e fecha os arquivos
+void stopRecording(void);
+
+#endif
@@ -0,0 +1,253 @@
+#include "headless.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#define CAMERA_FIELD_COUNT 6
+#define HEADLESS_LINE_LENGTH 512
+
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+static GLuint framebuffer = 0;
+static GLuint colorBuffer = 0;
+static GLuint depthBuffer = 0;
+
+bool parseHeadlessOption(int argc, char** argv, int* i, HeadlessOptions* options) {
+    const char* arg = argv[*i];
+    bool hasValue = *i + 1 < argc;
+
+    if (strcmp(arg, "--sem-janela") == 0) {
+        options->enabled = true;
+    } else if (strcmp(arg, "--camera") == 0 && hasValue) {
+        options->cameraPath = argv[++*i];
+    } else if (strcmp(arg, "--quadros") == 0 && hasValue) {
+        options->frameCount = atoi(argv[++*i]);
+    } else if (strcmp(arg, "--saida") == 0 && hasValue) {
+        options->outputDir = argv[++*i];
+    } else if (strcmp(arg, "--formato") == 0 && hasValue) {
+        if (!parseRecordingFormat(argv[++*i], &options->format)) {
+            fprintf(stderr, "Formato inválido: %s (use png, y4m ou ppm)\n", argv[*i]);
+        }
+    } else if (strcmp(arg, "--tamanho") == 0 && hasValue) {
+        int width, height;
+        if (sscanf(argv[++*i], "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+            options->width = width;
+            options->height = height;
+        } else {
+            fprintf(stderr, "Tamanho inválido: %s (use LARGURAxALTURA)\n", argv[*i]);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Lê os quadros-chave da trajetória, em ordem crescente de quadro
+static bool loadCameraPath(HeadlessOptions* options) {
+    FILE* file = fopen(options->cameraPath, "r");
+    if (!file) {
+        fprintf(stderr, "Falha ao abrir trajetória da câmera: %s\n", options->cameraPath);
+        return false;
+    }
+
+    char line[HEADLESS_LINE_LENGTH];
+    int lineNumber = 0;
+    int capacity = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') continue;
+
+        float values[CAMERA_FIELD_COUNT];
+        int fieldCount = 0;
+        while (fieldCount < CAMERA_FIELD_COUNT) {
+            char* end;
+            values[fieldCount] = strtof(p, &end);
+            if (end == p) break;
+            fieldCount++;
+            while (*end == ' ' || *end == '\t') end++;
+            if (*end != ',') break;
+            p = end + 1;
+        }
+        if (fieldCount != CAMERA_FIELD_COUNT) {
+            fprintf(stderr, "Trajetória %s, linha %d: esperados %d números\n",
+                    options->cameraPath, lineNumber, CAMERA_FIELD_COUNT);
+            continue;
+        }
+        if (options->keyframeCount > 0 &&
+            values[0] <= options->keyframes[options->keyframeCount - 1].frame) {
+            fprintf(stderr, "Trajetória %s, linha %d: quadros devem estar em ordem crescente\n",
+                    options->cameraPath, lineNumber);
+            continue;
+        }
+
+        if (options->keyframeCount == capacity) {
+            int newCapacity = capacity ? capacity * 2 : 16;
+            CameraKeyframe* newKeyframes = realloc(options->keyframes, (size_t)newCapacity * sizeof(CameraKeyframe));
+            if (!newKeyframes) {
+                fclose(file);
+                return false;
+            }
+            options->keyframes = newKeyframes;
+            capacity = newCapacity;
+        }
+        CameraKeyframe* key = &options->keyframes[options->keyframeCount++];
+        key->frame = values[0];
+        key->x = values[1];
+        key->y = values[2];
+        key->z = values[3];
+        key->yaw = values[4];
+        key->pitch = values[5];
+    }
+    fclose(file);
+
+    if (options->keyframeCount == 0) {
+        fprintf(stderr, "Trajetória sem quadros-chave: %s\n", options->cameraPath);
+        return false;
+    }
+    return true;
+}
+
+// Contexto OpenGL sem janela nem superfície: a plataforma surfaceless do Mesa quando
+// existir, senão o display padrão do EGL
+static bool createContext(void) {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay) {
+            eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        }
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, NULL, NULL)) {
+        fprintf(stderr, "Erro: EGL indisponível.\n");
+        return false;
+    }
+
+    const char* extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        fprintf(stderr, "Erro: EGL sem suporte a contexto sem superfície.\n");
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "Erro: EGL sem suporte a OpenGL.\n");
+        return false;
+    }
+
+    // Qualquer tipo de superfície serve, o desenho vai para o FBO
+    EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        fprintf(stderr, "Erro: nenhuma configuração EGL com OpenGL.\n");
+        return false;
+    }
+
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, NULL);
+    if (eglContext == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        fprintf(stderr, "Erro: falha ao criar o contexto EGL (0x%x).\n", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+// FBO com cor RGBA8 e profundidade de 24 bits, como a janela GLUT
+static bool createFramebuffer(int width, int height) {
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Erro: FBO incompleto.\n");
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+bool startHeadless(HeadlessOptions* options) {
+    if (options->cameraPath && !loadCameraPath(options)) return false;
+    if (!createContext()) return false;
+    if (!createFramebuffer(options->width, options->height)) return false;
+
+    printf("Modo sem janela: %dx%d, OpenGL %s (%s)\n", options->width, options->height,
+           (const char*)glGetString(GL_VERSION), (const char*)glGetString(GL_RENDERER));
+    return true;
+}
+
+int headlessFrameCount(const HeadlessOptions* options) {
+    if (options->frameCount > 0) return options->frameCount;
+    if (options->keyframeCount > 0) {
+        return (int)options->keyframes[options->keyframeCount - 1].frame + 1;
+    }
+    return 1;
+}
+
+bool sampleCameraPath(const HeadlessOptions* options, int frame, float* cameraX, float* cameraY,
+                      float* cameraZ, float* cameraYaw, float* cameraPitch) {
+    if (options->keyframeCount == 0) return false;
+
+    // Quadros-chave em volta do quadro (os mesmos dois fora do intervalo)
+    const CameraKeyframe* keys = options->keyframes;
+    int next = 0;
+    while (next < options->keyframeCount && keys[next].frame <= (float)frame) next++;
+    const CameraKeyframe* a = &keys[next > 0 ? next - 1 : 0];
+    const CameraKeyframe* b = &keys[next < options->keyframeCount ? next : options->keyframeCount - 1];
+
+    float t = 0.0f;
+    if (b->frame > a->frame) {
+        t = ((float)frame - a->frame) / (b->frame - a->frame);
+    }
+    *cameraX = -(a->x + (b->x - a->x) * t);
+    *cameraY = -(a->y + (b->y - a->y) * t);
+    *cameraZ = -(a->z + (b->z - a->z) * t);
+    *cameraYaw = a->yaw + (b->yaw - a->yaw) * t;
+    *cameraPitch = a->pitch + (b->pitch - a->pitch) * t;
+    return true;
+}
+
+void stopHeadless(HeadlessOptions* options) {
+    free(options->keyframes);
+    options->keyframes = NULL;
+    options->keyframeCount = 0;
+
+    if (framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        framebuffer = colorBuffer = depthBuffer = 0;
+    }
+    if (eglDisplay != EGL_NO_DISPLAY) {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (eglContext != EGL_NO_CONTEXT) eglDestroyContext(eglDisplay, eglContext);
+        eglTerminate(eglDisplay);
+        eglDisplay = EGL_NO_DISPLAY;
+        eglContext = EGL_NO_CONTEXT;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdbool.h>
+
+#include "gravacao.h"
+
+// Modo sem janela: em vez de uma janela GLUT, um contexto EGL sem superfície (funciona
+// com o llvmpipe do Mesa em máquinas sem tela) desenhando em um FBO. A câmera segue
+// uma trajetória lida de um arquivo e cada quadro é gravado em disco (gravacao.h).
+//
+// Trajetória da câmera em CSV, um quadro-chave por linha (linhas vazias e iniciadas
+// por '#' são ignoradas):
+//
+//   quadro,x,y,z,yaw,pitch
+//
+// x, y, z é a posição do observador em unidades GL; yaw e pitch em graus, como nos
+// controles do mouse. Entre dois quadros-chave a câmera é interpolada linearmente;
+// antes do primeiro e depois do último ela fica parada.
+
+typedef struct {
+    float frame;
+    float x, y, z;     // Posição do observador
+    float yaw, pitch;  // Graus
+} CameraKeyframe;
+
+typedef struct {
+    bool enabled;               // --sem-janela
+    int width, height;          // --tamanho LxA
+    int frameCount;             // --quadros N (0 = até o último quadro-chave)
+    const char* cameraPath;     // --camera arquivo.csv (NULL = câmera inicial parada)
+    const char* outputDir;      // --saida pasta (também usada pela gravação com janela)
+    RecordingFormat format;     // --formato png|y4m|ppm
+    CameraKeyframe* keyframes;
+    int keyframeCount;
+} HeadlessOptions;
+
+// Reconhece uma opção do modo sem janela em argv[*i], avançando *i se ela tiver valor.
+// Retorna false se o argumento não for uma dessas opções.
+bool parseHeadlessOption(int argc, char** argv, int* i, HeadlessOptions* options);
+
+// Lê a trajetória da câmera e cria o contexto EGL e o FBO. Depois disso as funções
+// do OpenGL podem ser chamadas normalmente.
+bool startHeadless(HeadlessOptions* options);
+
+// Número de quadros a gravar
+int headlessFrameCount(const HeadlessOptions* options);
+
+// Câmera do quadro nas variáveis dos programas (a translação da visão é o oposto da
+// posição do observador). Retorna false, sem mexer nelas, se não houver trajetória.
+bool sampleCameraPath(const HeadlessOptions* options, int frame, float* cameraX, float* cameraY,
+                      float* cameraZ, float* cameraYaw, float* cameraPitch);
+
+// Destrói o FBO e o contexto
+void stopHeadless(HeadlessOptions* options);
+
+#endif
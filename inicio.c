@@ -0,0 +1,55 @@
+#include "inicio.h"
+#include <stdio.h>
+#include <time.h>
+
+#define MAX_STARTUP_PHASES 32
+
+bool measureStartup = false;
+
+static struct {
+    const char* name;
+    double ms;
+} phases[MAX_STARTUP_PHASES];
+static int phaseCount = 0;
+static double startMs = 0.0;
+static double lastMarkMs = 0.0;
+static bool finished = false;
+
+static double nowMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+void beginStartupTimer(void) {
+    startMs = lastMarkMs = nowMs();
+    phaseCount = 0;
+    finished = false;
+}
+
+void markStartupPhase(const char* name) {
+    if (finished) return;
+    double now = nowMs();
+    if (phaseCount < MAX_STARTUP_PHASES) {
+        phases[phaseCount].name = name;
+        phases[phaseCount].ms = now - lastMarkMs;
+        phaseCount++;
+    }
+    lastMarkMs = now;
+}
+
+bool firstFramePresented(void) {
+    if (finished) return false;
+    markStartupPhase("primeiro quadro");
+    finished = true;
+
+    double total = lastMarkMs - startMs;
+    if (measureStartup) {
+        printf("Inicialização:\n");
+        for (int i = 0; i < phaseCount; i++) {
+            printf("  %8.1f ms  %s\n", phases[i].ms, phases[i].name);
+        }
+    }
+    printf("Primeiro quadro em %.1f ms\n", total);
+    return measureStartup;
+}
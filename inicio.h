@@ -0,0 +1,22 @@
+#ifndef INICIO_H
+#define INICIO_H
+
+#include <stdbool.h>
+
+// Tempo de inicialização: cada fase (GLUT, janela, catálogo, shaders, texturas...)
+// é marcada ao terminar, com o tempo desde a marca anterior, até o primeiro quadro
+// apresentado. Com --medir-inicio o programa mostra as fases e sai nesse quadro.
+
+extern bool measureStartup;
+
+// Zera o relógio (início do main)
+void beginStartupTimer(void);
+
+// Fecha a fase atual com o nome dado; a próxima começa agora
+void markStartupPhase(const char* name);
+
+// Chamar depois de apresentar um quadro: no primeiro, fecha a medição e mostra o
+// total (e as fases, com --medir-inicio). Devolve true se o programa deve sair.
+bool firstFramePresented(void);
+
+#endif
@@ -0,0 +1,78 @@
+// Exemplo de leitor do estado publicado pela simulação gravitacional com
+// --memoria-compartilhada: lê um estado consistente a cada intervalo e mostra o
+// passo, o tempo e os primeiros corpos. A leitura não trava a simulação, então
+// qualquer ritmo serve. Depois que a simulação termina, o mapeamento continua com
+// o último estado publicado.
+//
+// Uso: ./leitor_compartilhado [/nome] [--intervalo MS] [--leituras N] [--corpos K]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "compartilhado.h"
+
+#define DEFAULT_SHARED_NAME "/sistema_solar"
+#define DEFAULT_INTERVAL_MS 500
+#define DEFAULT_SHOWN_BODIES 4
+
+static void sleepMilliseconds(int milliseconds) {
+    struct timespec duration = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L };
+    nanosleep(&duration, NULL);
+}
+
+int main(int argc, char** argv) {
+    const char* name = DEFAULT_SHARED_NAME;
+    int interval = DEFAULT_INTERVAL_MS;
+    int reads = 0; // 0 = até o leitor ser interrompido
+    int shown = DEFAULT_SHOWN_BODIES;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--intervalo") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--leituras") == 0 && i + 1 < argc) {
+            reads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--corpos") == 0 && i + 1 < argc) {
+            shown = atoi(argv[++i]);
+        } else if (argv[i][0] == '/') {
+            name = argv[i];
+        } else {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const SharedStateHeader* header = attachSharedState(name);
+    if (!header) {
+        fprintf(stderr, "Memória compartilhada %s não encontrada (a simulação está rodando?)\n", name);
+        return 1;
+    }
+
+    // Um buffer do tamanho do segmento: cada leitura é uma cópia só
+    SharedBody* bodies = malloc((size_t)header->capacity * sizeof(SharedBody));
+    if (!bodies) {
+        fprintf(stderr, "Memória insuficiente para %u corpos\n", header->capacity);
+        return 1;
+    }
+
+    for (int r = 0; reads == 0 || r < reads; r++) {
+        SharedStateInfo info;
+        if (!readSharedState(header, bodies, (int)header->capacity, &info)) {
+            fprintf(stderr, "Estado sempre em escrita, tentando de novo\n");
+        } else {
+            printf("passo %llu, tempo %.3f, %d corpos\n",
+                   (unsigned long long)info.step, info.time, info.bodyCount);
+            for (int i = 0; i < info.bodyCount && i < shown; i++) {
+                printf("  corpo %d%s: posicao (%.4f, %.4f, %.4f) velocidade (%.4f, %.4f, %.4f)\n",
+                       bodies[i].id, bodies[i].fixed ? " (fixo)" : "",
+                       bodies[i].position[0], bodies[i].position[1], bodies[i].position[2],
+                       bodies[i].velocity[0], bodies[i].velocity[1], bodies[i].velocity[2]);
+            }
+        }
+        sleepMilliseconds(interval);
+    }
+
+    free(bodies);
+    detachSharedState(header);
+    return 0;
+}
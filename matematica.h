@@ -0,0 +1,287 @@
+#ifndef MATEMATICA_H
+#define MATEMATICA_H
+
+// Biblioteca pequena de vetores, matrizes 4x4 e quatérnios para calcular as
+// transformações na CPU. As matrizes seguem a convenção do OpenGL (coluna por
+// coluna) e podem ser passadas diretamente para glLoadMatrixf. Os tipos são
+// alinhados em 16 bytes e os laços têm largura 4 para o compilador vetorizar.
+
+#include <math.h>
+
+// Define M_PI se não estiver definido
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define DEG_TO_RAD(a) ((a) * (float)M_PI / 180.0f)
+
+// Vetor 3D (w é só preenchimento para alinhamento)
+typedef struct {
+    _Alignas(16) float x;
+    float y, z, w;
+} Vec3;
+
+// Matriz 4x4, elemento (linha, coluna) em m[coluna * 4 + linha]
+typedef struct {
+    _Alignas(16) float m[16];
+} Mat4;
+
+// Quatérnio de rotação (x, y, z) parte vetorial, w parte escalar
+typedef struct {
+    _Alignas(16) float x;
+    float y, z, w;
+} Quat;
+
+_Static_assert(sizeof(Vec3) == 16, "Vec3 deve ocupar um registrador de 16 bytes");
+_Static_assert(sizeof(Mat4) == 64, "Mat4 deve ter 16 floats sem preenchimento");
+_Static_assert(sizeof(Quat) == 16, "Quat deve ocupar um registrador de 16 bytes");
+
+// === Vetores ===
+
+static inline Vec3 vec3(float x, float y, float z) {
+    Vec3 v = { x, y, z, 0.0f };
+    return v;
+}
+
+static inline Vec3 vec3Add(Vec3 a, Vec3 b) {
+    return vec3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static inline Vec3 vec3Sub(Vec3 a, Vec3 b) {
+    return vec3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static inline Vec3 vec3Scale(Vec3 a, float s) {
+    return vec3(a.x * s, a.y * s, a.z * s);
+}
+
+static inline float vec3Dot(Vec3 a, Vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline Vec3 vec3Cross(Vec3 a, Vec3 b) {
+    return vec3(a.y * b.z - a.z * b.y,
+                a.z * b.x - a.x * b.z,
+                a.x * b.y - a.y * b.x);
+}
+
+static inline float vec3Length(Vec3 a) {
+    return sqrtf(vec3Dot(a, a));
+}
+
+static inline Vec3 vec3Normalize(Vec3 a) {
+    float len = vec3Length(a);
+    return len > 0.0f ? vec3Scale(a, 1.0f / len) : a;
+}
+
+// === Matrizes ===
+
+static inline Mat4 mat4Identity(void) {
+    Mat4 r = {{ 1, 0, 0, 0,
+                0, 1, 0, 0,
+                0, 0, 1, 0,
+                0, 0, 0, 1 }};
+    return r;
+}
+
+// r = a * b (aplica b primeiro, como glMultMatrix)
+static inline Mat4 mat4Multiply(const Mat4* a, const Mat4* b) {
+    Mat4 r;
+    for (int c = 0; c < 4; c++) {
+        for (int i = 0; i < 4; i++) {
+            r.m[c * 4 + i] = a->m[0 * 4 + i] * b->m[c * 4 + 0]
+                           + a->m[1 * 4 + i] * b->m[c * 4 + 1]
+                           + a->m[2 * 4 + i] * b->m[c * 4 + 2]
+                           + a->m[3 * 4 + i] * b->m[c * 4 + 3];
+        }
+    }
+    return r;
+}
+
+static inline Mat4 mat4Translation(float x, float y, float z) {
+    Mat4 r = mat4Identity();
+    r.m[12] = x;
+    r.m[13] = y;
+    r.m[14] = z;
+    return r;
+}
+
+// Rotação em graus em torno do eixo X (equivalente a glRotatef(angle, 1, 0, 0))
+static inline Mat4 mat4RotationX(float degrees) {
+    float c = cosf(DEG_TO_RAD(degrees)), s = sinf(DEG_TO_RAD(degrees));
+    Mat4 r = mat4Identity();
+    r.m[5] = c;  r.m[9] = -s;
+    r.m[6] = s;  r.m[10] = c;
+    return r;
+}
+
+// Rotação em graus em torno do eixo Y (equivalente a glRotatef(angle, 0, 1, 0))
+static inline Mat4 mat4RotationY(float degrees) {
+    float c = cosf(DEG_TO_RAD(degrees)), s = sinf(DEG_TO_RAD(degrees));
+    Mat4 r = mat4Identity();
+    r.m[0] = c;  r.m[8] = s;
+    r.m[2] = -s; r.m[10] = c;
+    return r;
+}
+
+// Projeção em perspectiva (equivalente a gluPerspective)
+static inline Mat4 mat4Perspective(float fovyDegrees, float aspect, float zNear, float zFar) {
+    float f = 1.0f / tanf(DEG_TO_RAD(fovyDegrees) * 0.5f);
+    Mat4 r = {{ 0 }};
+    r.m[0] = f / aspect;
+    r.m[5] = f;
+    r.m[10] = (zFar + zNear) / (zNear - zFar);
+    r.m[11] = -1.0f;
+    r.m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+    return r;
+}
+
+// Transforma um ponto (w = 1) e devolve o resultado antes da divisão perspectiva em out[4]
+static inline void mat4TransformPoint4(const Mat4* a, Vec3 p, float out[4]) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = a->m[0 * 4 + i] * p.x + a->m[1 * 4 + i] * p.y
+               + a->m[2 * 4 + i] * p.z + a->m[3 * 4 + i];
+    }
+}
+
+// Transforma um ponto com divisão perspectiva
+static inline Vec3 mat4TransformPoint(const Mat4* a, Vec3 p) {
+    float r[4];
+    mat4TransformPoint4(a, p, r);
+    float invW = r[3] != 0.0f ? 1.0f / r[3] : 1.0f;
+    return vec3(r[0] * invW, r[1] * invW, r[2] * invW);
+}
+
+// Linha i da parte 3x3 (para uma matriz de visão: eixo da câmera em coordenadas do mundo)
+static inline Vec3 mat4Row3(const Mat4* a, int i) {
+    return vec3(a->m[0 * 4 + i], a->m[1 * 4 + i], a->m[2 * 4 + i]);
+}
+
+// Inversa geral por cofatores. Retorna 0 se a matriz for singular.
+static inline int mat4Inverse(const Mat4* a, Mat4* out) {
+    const float* m = a->m;
+    float inv[16];
+
+    inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+    inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+    inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+    inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+    inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+    inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+    inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+    inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+    inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+    inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+    inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+    inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+    inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+    inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+    inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+    inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f) return 0;
+
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; i++) {
+        out->m[i] = inv[i] * invDet;
+    }
+    return 1;
+}
+
+// === Quatérnios ===
+
+static inline Quat quatIdentity(void) {
+    Quat q = { 0.0f, 0.0f, 0.0f, 1.0f };
+    return q;
+}
+
+// Rotação em graus em torno de um eixo (o eixo não precisa estar normalizado)
+static inline Quat quatFromAxisAngle(Vec3 axis, float degrees) {
+    Vec3 n = vec3Normalize(axis);
+    float half = DEG_TO_RAD(degrees) * 0.5f;
+    float s = sinf(half);
+    Quat q = { n.x * s, n.y * s, n.z * s, cosf(half) };
+    return q;
+}
+
+// r = a * b (aplica b primeiro)
+static inline Quat quatMultiply(Quat a, Quat b) {
+    Quat r = {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+    return r;
+}
+
+static inline Vec3 quatRotate(Quat q, Vec3 v) {
+    Vec3 u = vec3(q.x, q.y, q.z);
+    Vec3 t = vec3Scale(vec3Cross(u, v), 2.0f);
+    return vec3Add(vec3Add(v, vec3Scale(t, q.w)), vec3Cross(u, t));
+}
+
+// Matriz de modelo com rotação q seguida de translação t
+static inline Mat4 mat4FromQuatTranslation(Quat q, Vec3 t) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    Mat4 r = {{
+        1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz),        2.0f * (xz - wy),        0.0f,
+        2.0f * (xy - wz),        1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx),        0.0f,
+        2.0f * (xz + wy),        2.0f * (yz - wx),        1.0f - 2.0f * (xx + yy), 0.0f,
+        t.x,                     t.y,                     t.z,                     1.0f
+    }};
+    return r;
+}
+
+// === Frustum ===
+
+// Planos do frustum (a, b, c, d) extraídos de projeção * visão, normais para dentro
+typedef struct {
+    _Alignas(16) float planes[6][4];
+} Frustum;
+
+static inline Frustum frustumFromMatrix(const Mat4* viewProjection) {
+    const float* m = viewProjection->m;
+    Frustum f;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            f.planes[i * 2 + 0][j] = m[j * 4 + 3] + m[j * 4 + i];
+            f.planes[i * 2 + 1][j] = m[j * 4 + 3] - m[j * 4 + i];
+        }
+    }
+    for (int p = 0; p < 6; p++) {
+        float len = sqrtf(f.planes[p][0] * f.planes[p][0] + f.planes[p][1] * f.planes[p][1]
+                        + f.planes[p][2] * f.planes[p][2]);
+        for (int j = 0; j < 4; j++) {
+            f.planes[p][j] /= len;
+        }
+    }
+    return f;
+}
+
+// Verdadeiro se a esfera estiver pelo menos parcialmente dentro do frustum
+static inline int frustumContainsSphere(const Frustum* f, Vec3 center, float radius) {
+    for (int p = 0; p < 6; p++) {
+        float d = f->planes[p][0] * center.x + f->planes[p][1] * center.y
+                + f->planes[p][2] * center.z + f->planes[p][3];
+        if (d < -radius) return 0;
+    }
+    return 1;
+}
+
+// Distância ao longo do raio até a esfera, ou -1 se não houver interseção
+static inline float raySphereIntersect(Vec3 origin, Vec3 dir, Vec3 center, float radius) {
+    Vec3 oc = vec3Sub(origin, center);
+    float b = vec3Dot(oc, dir);
+    float c = vec3Dot(oc, oc) - radius * radius;
+    float disc = b * b - c;
+    if (disc < 0.0f) return -1.0f;
+    float t = -b - sqrtf(disc);
+    if (t < 0.0f) t = -b + sqrtf(disc);
+    return t >= 0.0f ? t : -1.0f;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "memoria.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+// Sem acentos: a fonte do HUD só tem ASCII
+static const char* categoryNames[MEMORY_CATEGORY_COUNT] = {
+    "texturas (CPU)", "texturas (GL)", "malhas", "corpos", "trajetorias", "indices"
+};
+
+static atomic_llong usage[MEMORY_CATEGORY_COUNT];
+static atomic_llong peak[MEMORY_CATEGORY_COUNT];
+static atomic_llong totalUsage;
+static atomic_llong totalPeak;
+
+// Sobe o pico se o valor novo passou dele (outra thread pode ter subido antes)
+static void raisePeak(atomic_llong* maximum, long long value) {
+    long long current = atomic_load(maximum);
+    while (value > current && !atomic_compare_exchange_weak(maximum, &current, value)) {
+    }
+}
+
+void trackMemory(MemoryCategory category, long long bytes) {
+    if (bytes == 0) return;
+    long long value = atomic_fetch_add(&usage[category], bytes) + bytes;
+    long long total = atomic_fetch_add(&totalUsage, bytes) + bytes;
+    if (bytes > 0) {
+        raisePeak(&peak[category], value);
+        raisePeak(&totalPeak, total);
+    }
+}
+
+void trackMemorySize(MemoryCategory category, size_t* tracked, size_t bytes) {
+    trackMemory(category, (long long)bytes - (long long)*tracked);
+    *tracked = bytes;
+}
+
+long long memoryUsage(MemoryCategory category) {
+    return atomic_load(&usage[category]);
+}
+
+static double toMiB(long long bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+int formatMemoryTable(char* text, size_t size) {
+    int length = snprintf(text, size, "%-16s %9s %9s  MB\n", "memoria", "atual", "pico");
+    for (int c = 0; c < MEMORY_CATEGORY_COUNT && length < (int)size; c++) {
+        length += snprintf(text + length, size - (size_t)length, "%-16s %9.2f %9.2f\n",
+                           categoryNames[c], toMiB(atomic_load(&usage[c])), toMiB(atomic_load(&peak[c])));
+    }
+    if (length < (int)size) {
+        length += snprintf(text + length, size - (size_t)length, "%-16s %9.2f %9.2f\n",
+                           "total", toMiB(atomic_load(&totalUsage)), toMiB(atomic_load(&totalPeak)));
+    }
+    return length;
+}
+
+static void printMemoryReport(void) {
+    char text[1024];
+    formatMemoryTable(text, sizeof(text));
+    printf("Memória por subsistema:\n%s", text);
+}
+
+void enableMemoryReport(void) {
+    atexit(printMemoryReport);
+}
@@ -0,0 +1,36 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Contabilidade de memória por subsistema: cada módulo informa o que aloca e libera
+// (na CPU ou, estimado, no OpenGL) e os totais aparecem no HUD e no relatório de
+// --relatorio-memoria. Os contadores são atômicos, porque as texturas são
+// decodificadas em outras threads.
+
+typedef enum {
+    MEMORY_TEXTURE_STAGING,  // Pixels decodificados ou mapeados do cache, ainda na CPU
+    MEMORY_TEXTURE_GL,       // Níveis de mipmap no OpenGL (estimado pelo formato)
+    MEMORY_MESHES,           // Malhas e buffers de vértices no OpenGL
+    MEMORY_BODIES,           // Vetores dos corpos e dos corpos menores
+    MEMORY_TRAJECTORIES,     // Geometria das órbitas
+    MEMORY_INDEXES,          // Tabelas de busca e árvores (catálogo)
+    MEMORY_CATEGORY_COUNT
+} MemoryCategory;
+
+// Soma bytes (negativos ao liberar) à categoria
+void trackMemory(MemoryCategory category, long long bytes);
+
+// Para áreas que mudam de tamanho: *tracked guarda o tamanho já contado
+void trackMemorySize(MemoryCategory category, size_t* tracked, size_t bytes);
+
+long long memoryUsage(MemoryCategory category);
+
+// Escreve a tabela (atual e pico de cada categoria e o total) em text, para o HUD
+int formatMemoryTable(char* text, size_t size);
+
+// Mostra a tabela no terminal na saída do programa
+void enableMemoryReport(void);
+
+#endif
@@ -0,0 +1,148 @@
+#include "orbitas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "memoria.h"
+#include "simulacao.h"
+
+// Define M_PI se não estiver definido
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Desvio máximo entre a curva e o segmento de reta (fração do semi-eixo maior)
+#define ORBIT_SAGITTA_TOLERANCE 0.001f
+// Limites de segmentos por órbita
+#define ORBIT_MIN_SEGMENTS 16
+#define ORBIT_MAX_SEGMENTS 2048
+
+// Cada vértice guarda posição (x, y, z) e cor (r, g, b)
+#define ORBIT_VERTEX_FLOATS 6
+
+static GLuint orbitVBO = 0;
+static GLint* orbitFirsts = NULL;   // Primeiro vértice de cada órbita no buffer
+static GLsizei* orbitCounts = NULL; // Número de vértices de cada órbita
+static int orbitPathCount = 0;
+static size_t orbitBytes = 0;       // Buffer e listas, contados em MEMORY_TRAJECTORIES
+
+void orbitPosition(const OrbitPath* path, float eccentricAnomaly, float out[3]) {
+    SimOrbit orbit = {
+        .semiMajorAxis = path->semiMajorAxis, .eccentricity = path->eccentricity,
+        .inclination = path->inclination, .ascendingNode = path->ascendingNode,
+        .argPeriapsis = path->argPeriapsis
+    };
+    simOrbitPosition(&orbit, eccentricAnomaly, out);
+}
+
+// Passo em anomalia excêntrica para manter o desvio da corda abaixo da tolerância.
+// Em regiões de alta curvatura (periastro de órbitas excêntricas) o passo diminui.
+static float orbitStep(float a, float b, float E) {
+    float s = sqrtf(a * a * sinf(E) * sinf(E) + b * b * cosf(E) * cosf(E)); // |dr/dE|
+    float radiusOfCurvature = s * s * s / (a * b);
+    float chord = 2.0f * sqrtf(2.0f * radiusOfCurvature * ORBIT_SAGITTA_TOLERANCE * a);
+    float step = chord / s;
+
+    float minStep = 2.0f * M_PI / ORBIT_MAX_SEGMENTS;
+    float maxStep = 2.0f * M_PI / ORBIT_MIN_SEGMENTS;
+    if (step < minStep) step = minStep;
+    if (step > maxStep) step = maxStep;
+    return step;
+}
+
+// Conta quantos vértices a órbita precisa com amostragem adaptativa
+static int orbitVertexCount(const OrbitPath* path) {
+    float a = path->semiMajorAxis;
+    float b = a * sqrtf(1.0f - path->eccentricity * path->eccentricity);
+    int count = 0;
+    for (float E = 0.0f; E < 2.0f * M_PI; E += orbitStep(a, b, E)) {
+        count++;
+    }
+    return count;
+}
+
+void buildOrbitPaths(const OrbitPath* paths, int count) {
+    freeOrbitPaths();
+    if (count <= 0) return;
+
+    orbitFirsts = malloc(count * sizeof(GLint));
+    orbitCounts = malloc(count * sizeof(GLsizei));
+    if (!orbitFirsts || !orbitCounts) {
+        fprintf(stderr, "Erro: Falha ao alocar memória para as órbitas.\n");
+        freeOrbitPaths();
+        return;
+    }
+
+    // Primeira passada: contar vértices de cada órbita
+    int totalVertices = 0;
+    for (int i = 0; i < count; i++) {
+        orbitFirsts[i] = totalVertices;
+        orbitCounts[i] = paths[i].semiMajorAxis > 0.0f ? orbitVertexCount(&paths[i]) : 0;
+        totalVertices += orbitCounts[i];
+    }
+
+    float* vertices = malloc((size_t)totalVertices * ORBIT_VERTEX_FLOATS * sizeof(float));
+    if (!vertices) {
+        fprintf(stderr, "Erro: Falha ao alocar memória para as órbitas.\n");
+        freeOrbitPaths();
+        return;
+    }
+
+    // Segunda passada: gerar posições e cores
+    for (int i = 0; i < count; i++) {
+        const OrbitPath* path = &paths[i];
+        float a = path->semiMajorAxis;
+        float b = a * sqrtf(1.0f - path->eccentricity * path->eccentricity);
+        float* v = vertices + (size_t)orbitFirsts[i] * ORBIT_VERTEX_FLOATS;
+        float E = 0.0f;
+        for (int j = 0; j < orbitCounts[i]; j++) {
+            orbitPosition(path, E, v);
+            v[3] = path->r;
+            v[4] = path->g;
+            v[5] = path->b;
+            v += ORBIT_VERTEX_FLOATS;
+            E += orbitStep(a, b, E);
+        }
+    }
+
+    glGenBuffers(1, &orbitVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, orbitVBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)totalVertices * ORBIT_VERTEX_FLOATS * sizeof(float),
+                 vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    free(vertices);
+    trackMemorySize(MEMORY_TRAJECTORIES, &orbitBytes,
+                    (size_t)totalVertices * ORBIT_VERTEX_FLOATS * sizeof(float)
+                    + (size_t)count * (sizeof(GLint) + sizeof(GLsizei)));
+
+    orbitPathCount = count;
+}
+
+void drawOrbitPaths(void) {
+    if (orbitVBO == 0 || orbitPathCount == 0) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, orbitVBO);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, ORBIT_VERTEX_FLOATS * sizeof(float), (const void*)0);
+    glColorPointer(3, GL_FLOAT, ORBIT_VERTEX_FLOATS * sizeof(float), (const void*)(3 * sizeof(float)));
+
+    glMultiDrawArrays(GL_LINE_LOOP, orbitFirsts, orbitCounts, orbitPathCount);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void freeOrbitPaths(void) {
+    if (orbitVBO != 0) {
+        glDeleteBuffers(1, &orbitVBO);
+        orbitVBO = 0;
+    }
+    free(orbitFirsts);
+    free(orbitCounts);
+    orbitFirsts = NULL;
+    orbitCounts = NULL;
+    orbitPathCount = 0;
+    trackMemorySize(MEMORY_TRAJECTORIES, &orbitBytes, 0);
+}
@@ -0,0 +1,30 @@
+#ifndef ORBITAS_H
+#define ORBITAS_H
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+
+// Elementos orbitais usados para gerar a geometria das órbitas
+typedef struct {
+    float semiMajorAxis;   // Semi-eixo maior em unidades GL
+    float eccentricity;    // Excentricidade (0 = círculo, < 1 = elipse)
+    float inclination;     // Inclinação em graus em relação ao plano XZ
+    float ascendingNode;   // Longitude do nodo ascendente em graus
+    float argPeriapsis;    // Argumento do periastro em graus
+    float r, g, b;         // Cor da linha da órbita
+} OrbitPath;
+
+// Posição na órbita para uma anomalia excêntrica (em radianos), pela mesma conta
+// da simulação (simOrbitPosition)
+void orbitPosition(const OrbitPath* path, float eccentricAnomaly, float out[3]);
+
+// Gera as polilinhas de todas as órbitas em um único buffer de vértices
+void buildOrbitPaths(const OrbitPath* paths, int count);
+
+// Desenha todas as órbitas com uma única chamada glMultiDrawArrays
+void drawOrbitPaths(void);
+
+// Libera o buffer de vértices das órbitas
+void freeOrbitPaths(void);
+
+#endif
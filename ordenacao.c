@@ -0,0 +1,125 @@
+#include "ordenacao.h"
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+// Abaixo disso, criar as threads custa mais que ordenar
+#define RADIX_PARALLEL_MIN 16384
+
+// Espalha os 21 bits de v para cada terceiro bit (bit i vai para o bit 3i)
+static uint64_t spreadBits(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+static uint64_t quantize(double value, double origin, double scale) {
+    double q = (value - origin) * scale;
+    if (!(q > 0.0)) return 0; // Também NaN
+    if (q >= (double)((1u << MORTON_BITS) - 1)) return (1u << MORTON_BITS) - 1;
+    return (uint64_t)q;
+}
+
+uint64_t mortonKey(double x, double y, double z, const double origin[3], double scale) {
+    return spreadBits(quantize(x, origin[0], scale))
+         | spreadBits(quantize(y, origin[1], scale)) << 1
+         | spreadBits(quantize(z, origin[2], scale)) << 2;
+}
+
+// Radix sort LSD de 8 bits por passada. Cada thread conta os dígitos da sua faixa
+// e espalha a faixa nas posições que a contagem lhe reservou, então a ordem entre
+// chaves iguais se mantém. Passadas em que todas as chaves têm o mesmo dígito
+// (os bits altos de um conjunto pequeno, por exemplo) são puladas.
+bool radixSortByKey(uint64_t* keys, int* order, int count, Arena* scratch) {
+    for (int i = 0; i < count; i++) order[i] = i;
+    if (count < 2) return true;
+
+    int maxThreads = arenaThreadCount();
+    uint64_t* otherKeys = arenaAlloc(scratch, (size_t)count * sizeof(uint64_t));
+    int* otherOrder = arenaAlloc(scratch, (size_t)count * sizeof(int));
+    size_t* histograms = arenaAlloc(scratch, (size_t)maxThreads * RADIX_BUCKETS * sizeof(size_t));
+    if (!otherKeys || !otherOrder || !histograms) return false;
+
+    uint64_t* sourceKeys = keys;
+    int* sourceOrder = order;
+    uint64_t* targetKeys = otherKeys;
+    int* targetOrder = otherOrder;
+    bool skipPass = false;
+
+    #pragma omp parallel if (count >= RADIX_PARALLEL_MIN)
+    {
+#ifdef _OPENMP
+        int thread = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+#else
+        int thread = 0;
+        int threads = 1;
+#endif
+        size_t begin = (size_t)count * thread / threads;
+        size_t end = (size_t)count * (thread + 1) / threads;
+        size_t* local = histograms + (size_t)thread * RADIX_BUCKETS;
+
+        for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+            memset(local, 0, RADIX_BUCKETS * sizeof(size_t));
+            for (size_t i = begin; i < end; i++) {
+                local[(sourceKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            }
+            #pragma omp barrier
+
+            // Início de cada (dígito, thread) no destino, dígito por dígito
+            #pragma omp single
+            {
+                skipPass = false;
+                size_t offset = 0;
+                for (int digit = 0; digit < RADIX_BUCKETS; digit++) {
+                    size_t digitTotal = 0;
+                    for (int t = 0; t < threads; t++) {
+                        size_t* bucket = &histograms[(size_t)t * RADIX_BUCKETS + digit];
+                        size_t n = *bucket;
+                        *bucket = offset;
+                        offset += n;
+                        digitTotal += n;
+                    }
+                    if (digitTotal == (size_t)count) skipPass = true;
+                }
+            }
+
+            if (!skipPass) {
+                for (size_t i = begin; i < end; i++) {
+                    size_t position = local[(sourceKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                    targetKeys[position] = sourceKeys[i];
+                    targetOrder[position] = sourceOrder[i];
+                }
+            }
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                if (!skipPass) {
+                    uint64_t* keysSwap = sourceKeys;
+                    sourceKeys = targetKeys;
+                    targetKeys = keysSwap;
+                    int* orderSwap = sourceOrder;
+                    sourceOrder = targetOrder;
+                    targetOrder = orderSwap;
+                }
+            }
+        }
+    }
+
+    // Número ímpar de passadas feitas: o resultado está nos vetores temporários
+    if (sourceKeys != keys) {
+        memcpy(keys, sourceKeys, (size_t)count * sizeof(uint64_t));
+        memcpy(order, sourceOrder, (size_t)count * sizeof(int));
+    }
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef ORDENACAO_H
+#define ORDENACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+// Ordenação espacial: chave de Morton (curva Z) de cada posição e ordenação das
+// chaves por radix sort paralelo. Corpos próximos no espaço ficam próximos na
+// memória depois de reordenados pela chave.
+
+// Bits por eixo na chave (3 * 21 = 63 bits)
+#define MORTON_BITS 21
+
+// Chave de Morton da posição quantizada em (p - origin) * scale, com cada eixo
+// limitado a [0, 2^21 - 1]
+uint64_t mortonKey(double x, double y, double z, const double origin[3], double scale);
+
+// Ordena keys e devolve em order a permutação: order[k] é o índice original do
+// k-ésimo menor (estável, empates mantêm a ordem). Memória temporária na arena.
+// Retorna false sem memória (keys e order ficam como estavam).
+bool radixSortByKey(uint64_t* keys, int* order, int count, Arena* scratch);
+
+#endif
@@ -0,0 +1,278 @@
+#include "perfil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include "memoria.h"
+#include "texto.h"
+
+#define PROFILE_STACK_DEPTH 8
+#define PROFILE_HUD_TEXT_SIZE 4096
+
+// Consultas de tempo da GPU: os resultados de um quadro são lidos GPU_LATENCY
+// quadros depois, quando já estão prontos, para não parar o desenho esperando
+#define GPU_LATENCY 4
+#define GPU_SEGMENTS 32 // Trechos medidos por quadro (uma fase aninhada divide a de fora)
+
+// Linhas extras do histórico, depois das fases
+#define ROW_DISPLAY PHASE_COUNT          // display() inteiro
+#define ROW_INTERVAL (PHASE_COUNT + 1)   // Do fim de um quadro ao fim do seguinte
+#define ROW_COUNT (PHASE_COUNT + 2)
+
+bool profilerEnabled = false;
+
+// Sem acentos: a fonte do HUD só tem ASCII
+static const char* rowNames[ROW_COUNT] = {
+    "fisica", "orbitas", "corpos", "aneis", "texturas", "asteroides", "rotulos", "troca",
+    "display", "intervalo"
+};
+
+// Histórico circular em milissegundos, uma linha por fase
+static float history[ROW_COUNT][PROFILE_HISTORY];
+static int historyNext = 0;
+static int historyCount = 0;
+
+// Quadro atual: tempo acumulado de cada fase e a pilha das fases abertas
+static double frameTimes[PHASE_COUNT];
+static ProfilePhase openPhases[PROFILE_STACK_DEPTH];
+static double openSince[PROFILE_STACK_DEPTH];
+static int openCount = 0;
+static double frameStart = 0.0;
+static double lastFrameEnd = 0.0;
+
+// Fases que também são medidas na GPU: as passadas de desenho
+static const bool gpuPhases[PHASE_COUNT] = {
+    [PHASE_ORBITS] = true, [PHASE_BODIES] = true, [PHASE_RINGS] = true,
+    [PHASE_SMALL_BODIES] = true, [PHASE_LABELS] = true
+};
+
+// Só uma consulta GL_TIME_ELAPSED pode estar ativa: ao abrir uma fase aninhada a
+// consulta da de fora termina, e outra começa quando a aninhada fecha
+typedef struct {
+    GLuint queries[GPU_SEGMENTS];
+    ProfilePhase phases[GPU_SEGMENTS];
+    int segmentCount;
+} GpuFrame;
+
+static bool gpuTimersAvailable = false;
+static GpuFrame gpuFrames[GPU_LATENCY];
+static unsigned int gpuWriteFrame = 0; // Quadros enviados
+static unsigned int gpuReadFrame = 0;  // Quadros já lidos (os do meio estão pendentes)
+static GpuFrame* gpuCurrent = NULL;    // Quadro sendo medido, NULL fora de display()
+static bool gpuQueryActive = false;
+
+static float gpuHistory[ROW_COUNT][PROFILE_HISTORY];
+static int gpuHistoryNext = 0;
+static int gpuHistoryCount = 0;
+
+const char* profilePhaseName(ProfilePhase phase) {
+    return rowNames[phase];
+}
+
+static double nowMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+static void beginGpuSegment(ProfilePhase phase) {
+    if (!gpuCurrent || !gpuPhases[phase] || gpuCurrent->segmentCount == GPU_SEGMENTS) return;
+    int segment = gpuCurrent->segmentCount++;
+    gpuCurrent->phases[segment] = phase;
+    glBeginQuery(GL_TIME_ELAPSED, gpuCurrent->queries[segment]);
+    gpuQueryActive = true;
+}
+
+static void endGpuSegment(void) {
+    if (!gpuQueryActive) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    gpuQueryActive = false;
+}
+
+void initProfiler(void) {
+    int major = 0, minor = 0;
+    const char* version = (const char*)glGetString(GL_VERSION);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) return;
+    gpuTimersAvailable = major > 3 || (major == 3 && minor >= 3)
+                      || (extensions && strstr(extensions, "GL_ARB_timer_query"));
+    if (!gpuTimersAvailable) {
+        fprintf(stderr, "Perfil sem tempos da GPU: GL_ARB_timer_query não disponível\n");
+        return;
+    }
+    for (int i = 0; i < GPU_LATENCY; i++) {
+        glGenQueries(GPU_SEGMENTS, gpuFrames[i].queries);
+    }
+}
+
+// Soma os trechos de cada fase de um quadro lido e guarda no histórico da GPU
+static void storeGpuFrame(const GpuFrame* frame) {
+    double times[PHASE_COUNT] = {0};
+    double total = 0.0;
+    for (int i = 0; i < frame->segmentCount; i++) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(frame->queries[i], GL_QUERY_RESULT, &elapsed);
+        times[frame->phases[i]] += elapsed / 1.0e6;
+        total += elapsed / 1.0e6;
+    }
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        gpuHistory[p][gpuHistoryNext] = (float)times[p];
+    }
+    gpuHistory[ROW_DISPLAY][gpuHistoryNext] = (float)total;
+    gpuHistoryNext = (gpuHistoryNext + 1) % PROFILE_HISTORY;
+    if (gpuHistoryCount < PROFILE_HISTORY) gpuHistoryCount++;
+}
+
+// Lê, em ordem, os quadros pendentes cujos resultados já chegaram. Os resultados
+// de um quadro chegam juntos: basta testar a última consulta.
+static void collectGpuFrames(void) {
+    while (gpuReadFrame != gpuWriteFrame) {
+        const GpuFrame* frame = &gpuFrames[gpuReadFrame % GPU_LATENCY];
+        if (frame->segmentCount > 0) {
+            GLuint available = 0;
+            glGetQueryObjectuiv(frame->queries[frame->segmentCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+        }
+        storeGpuFrame(frame);
+        gpuReadFrame++;
+    }
+}
+
+void profileBeginTimed(ProfilePhase phase) {
+    if (openCount == PROFILE_STACK_DEPTH) return;
+    double now = nowMs();
+    endGpuSegment();
+    beginGpuSegment(phase);
+
+    // A fase de fora para de contar enquanto esta estiver aberta
+    if (openCount > 0) {
+        frameTimes[openPhases[openCount - 1]] += now - openSince[openCount - 1];
+    }
+    openPhases[openCount] = phase;
+    openSince[openCount] = now;
+    openCount++;
+}
+
+void profileEndTimed(ProfilePhase phase) {
+    // Ligado no meio de um quadro: a fase não foi aberta
+    if (openCount == 0 || openPhases[openCount - 1] != phase) return;
+    double now = nowMs();
+
+    openCount--;
+    frameTimes[phase] += now - openSince[openCount];
+    if (openCount > 0) {
+        openSince[openCount - 1] = now;
+    }
+    endGpuSegment();
+    if (openCount > 0) beginGpuSegment(openPhases[openCount - 1]);
+}
+
+void toggleProfiler(void) {
+    profilerEnabled = !profilerEnabled;
+    historyNext = 0;
+    historyCount = 0;
+    openCount = 0;
+    lastFrameEnd = 0.0;
+    gpuHistoryNext = 0;
+    gpuHistoryCount = 0;
+    gpuReadFrame = gpuWriteFrame; // Resultados pendentes de antes são descartados
+    printf("Perfil de quadros: %s\n", profilerEnabled ? "ATIVADO" : "DESATIVADO");
+}
+
+void beginProfileFrame(void) {
+    if (!profilerEnabled) return;
+    memset(frameTimes, 0, sizeof(frameTimes));
+    openCount = 0;
+    frameStart = nowMs();
+
+    if (gpuTimersAvailable) {
+        collectGpuFrames();
+        // Todos os quadros do anel ainda pendentes: espera o mais antigo (raro)
+        if (gpuWriteFrame - gpuReadFrame == GPU_LATENCY) {
+            storeGpuFrame(&gpuFrames[gpuReadFrame % GPU_LATENCY]);
+            gpuReadFrame++;
+        }
+        gpuCurrent = &gpuFrames[gpuWriteFrame % GPU_LATENCY];
+        gpuCurrent->segmentCount = 0;
+    }
+}
+
+void endProfileFrame(void) {
+    if (!profilerEnabled || frameStart == 0.0) return;
+    double now = nowMs();
+
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        history[p][historyNext] = (float)frameTimes[p];
+    }
+    history[ROW_DISPLAY][historyNext] = (float)(now - frameStart);
+    history[ROW_INTERVAL][historyNext] = (float)(lastFrameEnd > 0.0 ? now - lastFrameEnd : now - frameStart);
+    lastFrameEnd = now;
+    frameStart = 0.0;
+
+    if (gpuCurrent) {
+        endGpuSegment();
+        gpuCurrent = NULL;
+        gpuWriteFrame++;
+    }
+
+    historyNext = (historyNext + 1) % PROFILE_HISTORY;
+    if (historyCount < PROFILE_HISTORY) historyCount++;
+}
+
+static int compareFloats(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Mínimo, média e p99 de um histórico
+static void summarize(const float* values, int count, float* minimum, float* average, float* p99) {
+    float sorted[PROFILE_HISTORY];
+    memcpy(sorted, values, (size_t)count * sizeof(float));
+    qsort(sorted, (size_t)count, sizeof(float), compareFloats);
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += sorted[i];
+    *minimum = sorted[0];
+    *average = (float)(sum / count);
+    *p99 = sorted[(count * 99 + 99) / 100 - 1]; // Posição do percentil 99 (arredondada para cima)
+}
+
+void drawProfilerHud(int viewportWidth, int viewportHeight) {
+    if (!profilerEnabled || historyCount == 0) return;
+
+    char text[PROFILE_HUD_TEXT_SIZE];
+    int length = snprintf(text, sizeof(text), "%-11s %7s %7s %7s %9s %7s  ms (%d quadros)\n",
+                          "fase", "min", "media", "p99", "gpu media", "gpu p99", historyCount);
+
+    float intervalAverage = 0.0f;
+    for (int row = 0; row < ROW_COUNT && length < (int)sizeof(text); row++) {
+        float minimum, average, p99;
+        summarize(history[row], historyCount, &minimum, &average, &p99);
+        if (row == ROW_INTERVAL) intervalAverage = average;
+        length += snprintf(text + length, sizeof(text) - (size_t)length, "%-11s %7.3f %7.3f %7.3f",
+                           rowNames[row], minimum, average, p99);
+        if (length >= (int)sizeof(text)) break;
+
+        // A linha do display na GPU é a soma das passadas medidas
+        bool gpuRow = row == ROW_DISPLAY || (row < PHASE_COUNT && gpuPhases[row]);
+        if (gpuRow && gpuHistoryCount > 0) {
+            summarize(gpuHistory[row], gpuHistoryCount, &minimum, &average, &p99);
+            length += snprintf(text + length, sizeof(text) - (size_t)length, " %9.3f %7.3f\n", average, p99);
+        } else {
+            length += snprintf(text + length, sizeof(text) - (size_t)length, " %9s %7s\n", "-", "-");
+        }
+    }
+    if (length < (int)sizeof(text) && intervalAverage > 0.0f) {
+        length += snprintf(text + length, sizeof(text) - (size_t)length, "%.1f quadros/s\n", 1000.0 / intervalAverage);
+    }
+    if (length < (int)sizeof(text) - 1) {
+        text[length++] = '\n';
+        formatMemoryTable(text + length, sizeof(text) - (size_t)length);
+    }
+
+    drawScreenText(text, 8, 8, viewportWidth, viewportHeight);
+}
@@ -0,0 +1,63 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <stdbool.h>
+
+#include "rastro.h"
+
+// Perfil dos quadros: tempo de CPU de cada fase de display(), guardado em um
+// histórico circular dos últimos PROFILE_HISTORY quadros e mostrado em um HUD com
+// mínimo, média e p99 de cada fase. As fases podem ser aninhadas (anéis dentro dos
+// corpos): o tempo da interna não conta na externa. Desligado, cada marcação custa
+// só o teste de profilerEnabled. As passadas de desenho também são medidas na GPU
+// com consultas GL_TIME_ELAPSED, lidas alguns quadros depois. Com o rastro ligado,
+// cada fase também vira um trecho dele.
+
+#define PROFILE_HISTORY 240
+
+typedef enum {
+    PHASE_PHYSICS,
+    PHASE_ORBITS,
+    PHASE_BODIES,
+    PHASE_RINGS,
+    PHASE_TEXTURES,
+    PHASE_SMALL_BODIES,
+    PHASE_LABELS,
+    PHASE_SWAP,
+    PHASE_COUNT
+} ProfilePhase;
+
+extern bool profilerEnabled;
+
+void profileBeginTimed(ProfilePhase phase);
+void profileEndTimed(ProfilePhase phase);
+
+// Nome da fase no HUD e no rastro
+const char* profilePhaseName(ProfilePhase phase);
+
+static inline void profileBegin(ProfilePhase phase) {
+    if (profilerEnabled) profileBeginTimed(phase);
+    if (tracingEnabled) traceBeginSpan(profilePhaseName(phase));
+}
+
+static inline void profileEnd(ProfilePhase phase) {
+    if (profilerEnabled) profileEndTimed(phase);
+    if (tracingEnabled) traceEndSpan();
+}
+
+// Cria as consultas de tempo da GPU, se houver GL_ARB_timer_query. Chamar com o
+// contexto OpenGL já criado.
+void initProfiler(void);
+
+// Liga ou desliga o perfil e o HUD (o histórico recomeça ao ligar)
+void toggleProfiler(void);
+
+// Início e fim de display(): o fim guarda as fases e o total do quadro no histórico
+void beginProfileFrame(void);
+void endProfileFrame(void);
+
+// Desenha a tabela de tempos, e abaixo dela a de memória, no canto superior
+// esquerdo da tela
+void drawProfilerHud(int viewportWidth, int viewportHeight);
+
+#endif
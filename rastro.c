@@ -0,0 +1,192 @@
+#include "rastro.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define TRACE_NAME_LENGTH 48
+#define TRACE_THREAD_NAME_LENGTH 32
+#define TRACE_CHUNK_EVENTS 1024
+#define TRACE_STACK_DEPTH 32
+#define TRACE_PATH_LENGTH 1024
+
+// Um trecho terminado (evento "X" do trace_event), com o nome copiado para não
+// depender da vida da string de quem marcou
+typedef struct {
+    char name[TRACE_NAME_LENGTH];
+    double start;    // Microssegundos desde o início do rastro
+    double duration;
+} TraceEvent;
+
+// Os eventos de uma thread ficam em blocos encadeados: só ela escreve, e publica
+// cada evento aumentando count (release) depois de preenchê-lo. Quem escreve o
+// arquivo lê count (acquire) e só os eventos até ali, sem travar ninguém.
+typedef struct TraceChunk {
+    TraceEvent events[TRACE_CHUNK_EVENTS];
+    atomic_int count;
+    _Atomic(struct TraceChunk*) next;
+} TraceChunk;
+
+typedef struct TraceBuffer {
+    int threadId;
+    char threadName[TRACE_THREAD_NAME_LENGTH];
+    TraceChunk* first;
+    TraceChunk* current;               // Só a thread dona usa
+    struct TraceBuffer* nextBuffer;    // Lista de todos os buffers (só cresce)
+} TraceBuffer;
+
+bool tracingEnabled = false;
+
+static char tracePath[TRACE_PATH_LENGTH];
+static double traceStart = 0.0;
+static _Atomic(TraceBuffer*) buffers = NULL;
+static atomic_int nextThreadId = 1;
+
+// Buffer e pilha de trechos abertos de cada thread
+static _Thread_local TraceBuffer* localBuffer = NULL;
+static _Thread_local struct {
+    const char* name;
+    double start;
+} openSpans[TRACE_STACK_DEPTH];
+static _Thread_local int openCount = 0;
+
+static double nowUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1.0e6 + now.tv_nsec / 1.0e3;
+}
+
+static TraceChunk* newChunk(void) {
+    TraceChunk* chunk = malloc(sizeof(TraceChunk));
+    if (!chunk) return NULL;
+    atomic_init(&chunk->count, 0);
+    atomic_init(&chunk->next, NULL);
+    return chunk;
+}
+
+// Cria o buffer da thread na primeira marcação e o põe na lista (troca atômica
+// da cabeça, sem trava)
+static TraceBuffer* threadBuffer(void) {
+    if (localBuffer) return localBuffer;
+
+    TraceBuffer* buffer = calloc(1, sizeof(TraceBuffer));
+    if (!buffer) return NULL;
+    buffer->first = buffer->current = newChunk();
+    if (!buffer->first) {
+        free(buffer);
+        return NULL;
+    }
+    buffer->threadId = atomic_fetch_add(&nextThreadId, 1);
+    snprintf(buffer->threadName, sizeof(buffer->threadName), "thread %d", buffer->threadId);
+
+    TraceBuffer* head = atomic_load(&buffers);
+    do {
+        buffer->nextBuffer = head;
+    } while (!atomic_compare_exchange_weak(&buffers, &head, buffer));
+
+    localBuffer = buffer;
+    return buffer;
+}
+
+static void appendEvent(const char* name, double start, double end) {
+    TraceBuffer* buffer = threadBuffer();
+    if (!buffer) return;
+
+    TraceChunk* chunk = buffer->current;
+    int count = atomic_load_explicit(&chunk->count, memory_order_relaxed);
+    if (count == TRACE_CHUNK_EVENTS) {
+        TraceChunk* next = newChunk();
+        if (!next) return; // Sem memória: o trecho se perde
+        atomic_store_explicit(&chunk->next, next, memory_order_release);
+        buffer->current = chunk = next;
+        count = 0;
+    }
+
+    TraceEvent* event = &chunk->events[count];
+    snprintf(event->name, sizeof(event->name), "%s", name);
+    event->start = start - traceStart;
+    event->duration = end - start;
+    atomic_store_explicit(&chunk->count, count + 1, memory_order_release);
+}
+
+void traceThreadName(const char* name) {
+    if (!tracingEnabled) return;
+    TraceBuffer* buffer = threadBuffer();
+    if (buffer) snprintf(buffer->threadName, sizeof(buffer->threadName), "%s", name);
+}
+
+void traceBeginSpan(const char* name) {
+    if (openCount < TRACE_STACK_DEPTH) {
+        openSpans[openCount].name = name;
+        openSpans[openCount].start = nowUs();
+    }
+    openCount++; // Além da pilha só conta, para os fins continuarem casando
+}
+
+void traceEndSpan(void) {
+    if (openCount == 0) return; // Rastro ligado no meio de um trecho
+    openCount--;
+    if (openCount < TRACE_STACK_DEPTH) {
+        appendEvent(openSpans[openCount].name, openSpans[openCount].start, nowUs());
+    }
+}
+
+// Escreve um texto como string JSON (os nomes são curtos e sem controle, mas
+// aspas e barras precisam de escape)
+static void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+void flushTrace(void) {
+    if (!tracingEnabled) return;
+    FILE* file = fopen(tracePath, "w");
+    if (!file) {
+        fprintf(stderr, "Falha ao escrever rastro: %s\n", tracePath);
+        return;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    bool first = true;
+    int eventCount = 0;
+    for (TraceBuffer* buffer = atomic_load(&buffers); buffer; buffer = buffer->nextBuffer) {
+        fprintf(file, "%s\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": ",
+                first ? "" : ",", buffer->threadId);
+        writeJsonString(file, buffer->threadName);
+        fprintf(file, "}}");
+        first = false;
+
+        for (TraceChunk* chunk = buffer->first; chunk;
+             chunk = atomic_load_explicit(&chunk->next, memory_order_acquire)) {
+            int count = atomic_load_explicit(&chunk->count, memory_order_acquire);
+            for (int i = 0; i < count; i++) {
+                const TraceEvent* event = &chunk->events[i];
+                fprintf(file, ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, \"name\": ",
+                        buffer->threadId, event->start, event->duration);
+                writeJsonString(file, event->name);
+                fputc('}', file);
+            }
+            eventCount += count;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    printf("Rastro: %d trechos escritos em %s\n", eventCount, tracePath);
+}
+
+bool startTracing(const char* path) {
+    if (strlen(path) >= sizeof(tracePath)) return false;
+    strcpy(tracePath, path);
+    traceStart = nowUs();
+    tracingEnabled = true;
+    traceThreadName("principal");
+
+    // Escrito em qualquer saída do programa (ESC, fim da repetição ou do modo sem janela)
+    atexit(flushTrace);
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef RASTRO_H
+#define RASTRO_H
+
+#include <stdbool.h>
+
+// Rastro de execução no formato trace_event do Chrome (abre no Perfetto ou em
+// chrome://tracing): cada trecho marcado com traceBegin/traceEnd vira uma barra na
+// linha do tempo da thread que o executou. Cada thread escreve só no próprio
+// buffer, sem travas; o arquivo é escrito na saída do programa ou quando pedido
+// (tecla K), com tudo o que foi gravado até ali. Desligado, cada marcação custa só
+// o teste de tracingEnabled.
+
+extern bool tracingEnabled;
+
+// Começa a gravar o rastro, escrito em path na saída do programa
+bool startTracing(const char* path);
+
+// Nome da thread atual no rastro (senão "thread N")
+void traceThreadName(const char* name);
+
+void traceBeginSpan(const char* name);
+void traceEndSpan(void);
+
+static inline void traceBegin(const char* name) {
+    if (tracingEnabled) traceBeginSpan(name);
+}
+
+static inline void traceEnd(void) {
+    if (tracingEnabled) traceEndSpan();
+}
+
+// Escreve o arquivo com todos os trechos já terminados
+void flushTrace(void);
+
+#endif
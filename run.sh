@@ -1,2 +1,7 @@
 #!/bin/bash
-gcc $1 -o ${1%.*} -lGL -lGLU -lglut -lm && ./${1%.*}
\ No newline at end of file
+# Compila e roda o programa principal; os argumentos vão para o programa
+# (ex.: ./run.sh --asteroides 3000). A simulação gravitacional tem o run_gravity.sh.
+MODULOS="agendador.c catalogo.c corpos_menores.c entrada.c esferas.c estado_gl.c gravacao.c headless.c inicio.c memoria.c orbitas.c perfil.c rastro.c texto.c textura.c"
+# Aceita a forma antiga, ./run.sh SistemaSolar.c
+if [ "$1" = "SistemaSolar.c" ]; then shift; fi
+./build_lib.sh && gcc SistemaSolar.c $MODULOS -o SistemaSolar -L. -lsistemasolar -lGL -lGLU -lglut -lEGL -lz -lm -fopenmp -pthread && ./SistemaSolar "$@"
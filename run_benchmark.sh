@@ -0,0 +1,3 @@
+#!/bin/bash
+# Benchmark da gravidade, sem OpenGL (CFLAGS troca as opções de compilação, padrão -O2)
+gcc ${CFLAGS:--O2} benchmark_gravidade.c arena.c ordenacao.c -o benchmark_gravidade -lm -fopenmp && ./benchmark_gravidade "$@"
@@ -1,2 +1,3 @@
 #!/bin/bash
-gcc SistemaSolarGravity.c -o SistemaSolarGravity -lGL -lGLU -lglut -lm && ./SistemaSolarGravity 
\ No newline at end of file
+# Os argumentos vão para o programa (ex.: ./run_gravity.sh --metricas m.jsonl)
+./build_lib.sh && gcc SistemaSolarGravity.c agendador.c compartilhado.c conservacao.c entrada.c gravacao.c headless.c rastro.c -o SistemaSolarGravity -L. -lsistemasolar -lGL -lGLU -lglut -lEGL -lz -lm -fopenmp -pthread && ./SistemaSolarGravity "$@"
@@ -0,0 +1,3 @@
+#!/bin/bash
+# Leitor de exemplo do estado publicado com ./SistemaSolarGravity --memoria-compartilhada /nome
+gcc leitor_compartilhado.c compartilhado.c -o leitor_compartilhado && ./leitor_compartilhado "$@"
@@ -0,0 +1,609 @@
+#include "simulacao.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "arena.h"
+#include "ordenacao.h"
+
+// Define M_PI se não estiver definido
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Abaixo disso, criar as threads custa mais que as interações entre os corpos
+#define PARALLEL_MIN_BODIES 64
+
+// Pares mais próximos que a distância mínima das forças (a força entre eles é
+// ignorada): candidatos a colisão do passo, na arena do passo. Cada thread junta os
+// seus em blocos na própria arena durante o laço dos pares.
+#define PAIR_CHUNK_SIZE 64
+
+typedef struct {
+    int first, second;
+} BodyPair;
+
+typedef struct PairChunk {
+    struct PairChunk* next;
+    int count;
+    BodyPair pairs[PAIR_CHUNK_SIZE];
+} PairChunk;
+
+typedef struct {
+    double posX, posY, posZ;     // Posição
+    double velX, velY, velZ;     // Velocidade
+    double accX, accY, accZ;     // Aceleração
+    double mass;
+    SimBodyKind kind;
+    int id;                      // Ordem de criação (o índice muda quando os corpos são reordenados)
+    // Corpos em órbita
+    SimOrbit orbit;
+    int parent;                  // Id do pai, -1 se não houver
+    float meanAnomaly;           // Graus
+    float orbitalSpeed;
+    // Todos
+    float rotationAngle;
+    float rotationSpeed;
+} Body;
+
+struct Simulation {
+    SimulationConfig config;
+    Body* bodies;
+    int* indexById;              // Índice atual em bodies de cada id
+    int bodyCount;
+    int capacity;
+    int freeCount;               // Corpos integrados pela gravidade
+    int orbitCount;              // Corpos em órbita (com eles a ordem não pode mudar)
+    int spinningCount;           // Corpos com rotação
+
+    double time;                 // Soma dos passos já simulados
+    uint64_t steps;
+
+    StepArenas arenas;           // Dados temporários do passo
+    BodyPair* closePairs;        // Válidos até o próximo passo
+    int closePairCount;
+
+    bool measureConservation;
+    bool collectPotential;
+    double potentialEnergy;
+    SimConservation lastSample;
+    bool hasSample;
+
+    void (*phaseBegin)(const char* phase);
+    void (*phaseEnd)(void);
+};
+
+SimulationConfig simDefaultConfig(void) {
+    return (SimulationConfig){
+        .timeStep = SIM_DEFAULT_TIME_STEP,
+        .gravitationalFactor = SIM_DEFAULT_GRAVITATIONAL_FACTOR,
+        .minDistanceSq = SIM_DEFAULT_MIN_DISTANCE_SQ,
+        .orbitTimeScale = 1.0f,
+        .reorderInterval = SIM_DEFAULT_REORDER_INTERVAL
+    };
+}
+
+static void beginPhase(const Simulation* sim, const char* phase) {
+    if (sim->phaseBegin) sim->phaseBegin(phase);
+}
+
+static void endPhase(const Simulation* sim) {
+    if (sim->phaseEnd) sim->phaseEnd();
+}
+
+Simulation* simCreate(const SimulationConfig* config) {
+    Simulation* sim = calloc(1, sizeof(Simulation));
+    if (!sim) return NULL;
+    sim->config = config ? *config : simDefaultConfig();
+    return sim;
+}
+
+void simDestroy(Simulation* sim) {
+    if (!sim) return;
+    freeStepArenas(&sim->arenas);
+    free(sim->bodies);
+    free(sim->indexById);
+    free(sim);
+}
+
+float simSolveKepler(float meanAnomaly, float eccentricity) {
+    if (eccentricity == 0.0f) return meanAnomaly;
+
+    // Método de Newton; para órbitas muito excêntricas começar em pi converge melhor
+    float E = eccentricity < 0.8f ? meanAnomaly : (float)M_PI;
+    for (int i = 0; i < 8; i++) {
+        float delta = (E - eccentricity * sinf(E) - meanAnomaly) / (1.0f - eccentricity * cosf(E));
+        E -= delta;
+        if (fabsf(delta) < 1e-6f) break;
+    }
+    return E;
+}
+
+void simOrbitPosition(const SimOrbit* orbit, float eccentricAnomaly, float out[3]) {
+    float a = orbit->semiMajorAxis;
+    float e = orbit->eccentricity;
+    float b = a * sqrtf(1.0f - e * e);
+
+    // Posição no plano da órbita com o foco (Sol) na origem
+    float xp = a * (cosf(eccentricAnomaly) - e);
+    float yp = b * sinf(eccentricAnomaly);
+
+    // Girar pelo argumento do periastro
+    float w = orbit->argPeriapsis * M_PI / 180.0f;
+    float u = xp * cosf(w) - yp * sinf(w);
+    float v = xp * sinf(w) + yp * cosf(w);
+
+    // Aplicar inclinação e nodo ascendente (Y é o eixo "para cima" da cena)
+    float inc = orbit->inclination * M_PI / 180.0f;
+    float node = orbit->ascendingNode * M_PI / 180.0f;
+    out[0] = u * cosf(node) - v * cosf(inc) * sinf(node);
+    out[1] = v * sinf(inc);
+    out[2] = u * sinf(node) + v * cosf(inc) * cosf(node);
+}
+
+// Posicionar o corpo na sua órbita em relação ao pai. Com corpos em órbita a
+// simulação não reordena, então o pai (adicionado antes) já foi atualizado.
+static void updateOrbitalPosition(Simulation* sim, Body* body) {
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    if (body->orbit.semiMajorAxis > 0.0f) {
+        float E = simSolveKepler(body->meanAnomaly * M_PI / 180.0f, body->orbit.eccentricity);
+        simOrbitPosition(&body->orbit, E, position);
+    }
+    if (body->parent >= 0) {
+        const Body* parent = &sim->bodies[sim->indexById[body->parent]];
+        position[0] += (float)parent->posX;
+        position[1] += (float)parent->posY;
+        position[2] += (float)parent->posZ;
+    }
+    body->posX = position[0];
+    body->posY = position[1];
+    body->posZ = position[2];
+}
+
+int simAddBody(Simulation* sim, const SimBody* body) {
+    if (body->kind == SIM_BODY_ORBIT && (body->parent < -1 || body->parent >= sim->bodyCount)) return -1;
+    if (sim->bodyCount == sim->capacity) {
+        int newCapacity = sim->capacity ? sim->capacity * 2 : 16;
+        Body* newBodies = realloc(sim->bodies, (size_t)newCapacity * sizeof(Body));
+        if (!newBodies) return -1;
+        sim->bodies = newBodies;
+        int* newIndex = realloc(sim->indexById, (size_t)newCapacity * sizeof(int));
+        if (!newIndex) return -1;
+        sim->indexById = newIndex;
+        sim->capacity = newCapacity;
+    }
+
+    // O corpo novo fica no fim: o índice dele é o id
+    int id = sim->bodyCount;
+    Body* added = &sim->bodies[id];
+    *added = (Body){
+        .posX = body->position[0], .posY = body->position[1], .posZ = body->position[2],
+        .velX = body->velocity[0], .velY = body->velocity[1], .velZ = body->velocity[2],
+        .mass = body->mass,
+        .kind = body->kind,
+        .id = id,
+        .orbit = body->orbit,
+        .parent = body->kind == SIM_BODY_ORBIT ? body->parent : -1,
+        .meanAnomaly = body->meanAnomaly,
+        .orbitalSpeed = body->orbitalSpeed,
+        .rotationSpeed = body->rotationSpeed
+    };
+    if (body->kind == SIM_BODY_FIXED) {
+        added->velX = added->velY = added->velZ = 0.0;
+    }
+    sim->indexById[id] = id;
+    sim->bodyCount++;
+
+    if (body->kind == SIM_BODY_FREE) sim->freeCount++;
+    if (body->rotationSpeed != 0.0f) sim->spinningCount++;
+    if (body->kind == SIM_BODY_ORBIT) {
+        // Corpos novos vão para o fim, depois do pai; sem reordenar daqui em diante,
+        // os pais continuam antes dos filhos
+        sim->orbitCount++;
+        added->velX = added->velY = added->velZ = 0.0;
+        updateOrbitalPosition(sim, added);
+    }
+    return id;
+}
+
+// Reordena bodies pela chave de Morton das posições (dentro da caixa que envolve
+// todos os corpos) e atualiza indexById. Usa a arena do passo.
+static void reorderBodies(Simulation* sim) {
+    Body* bodies = sim->bodies;
+    int count = sim->bodyCount;
+    if (count < 2) return;
+
+    double minX = bodies[0].posX, minY = bodies[0].posY, minZ = bodies[0].posZ;
+    double maxX = minX, maxY = minY, maxZ = minZ;
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN_BODIES) \
+        reduction(min:minX, minY, minZ) reduction(max:maxX, maxY, maxZ)
+    for (int i = 0; i < count; i++) {
+        minX = fmin(minX, bodies[i].posX); maxX = fmax(maxX, bodies[i].posX);
+        minY = fmin(minY, bodies[i].posY); maxY = fmax(maxY, bodies[i].posY);
+        minZ = fmin(minZ, bodies[i].posZ); maxZ = fmax(maxZ, bodies[i].posZ);
+    }
+    double extent = fmax(maxX - minX, fmax(maxY - minY, maxZ - minZ));
+    if (!(extent > 0.0)) return; // Todos no mesmo ponto (ou posições inválidas)
+    double origin[3] = { minX, minY, minZ };
+    double scale = ((1u << MORTON_BITS) - 1) / extent;
+
+    Arena* arena = stepArena(&sim->arenas);
+    uint64_t* keys = arenaAlloc(arena, (size_t)count * sizeof(uint64_t));
+    int* order = arenaAlloc(arena, (size_t)count * sizeof(int));
+    if (!keys || !order) return; // Sem memória: fica a ordem atual
+
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN_BODIES)
+    for (int i = 0; i < count; i++) {
+        keys[i] = mortonKey(bodies[i].posX, bodies[i].posY, bodies[i].posZ, origin, scale);
+    }
+    if (!radixSortByKey(keys, order, count, arena)) return;
+
+    // Aplica a permutação no lugar, um ciclo por vez: a posição k recebe o corpo
+    // que estava em order[k], e order[k] = k marca a posição como resolvida
+    for (int k = 0; k < count; k++) {
+        if (order[k] == k) continue;
+        Body saved = bodies[k];
+        int j = k;
+        while (true) {
+            int source = order[j];
+            order[j] = j;
+            if (source == k) {
+                bodies[j] = saved;
+                break;
+            }
+            bodies[j] = bodies[source];
+            j = source;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        sim->indexById[bodies[i].id] = i;
+    }
+}
+
+// Guarda um par próximo demais na lista da thread, em blocos da arena dela
+static void addClosePair(PairChunk** list, Arena* arena, int first, int second) {
+    PairChunk* chunk = *list;
+    if (!chunk || chunk->count == PAIR_CHUNK_SIZE) {
+        chunk = arenaAlloc(arena, sizeof(PairChunk));
+        if (!chunk) return; // Sem memória: o par não entra na lista
+        chunk->next = *list;
+        chunk->count = 0;
+        *list = chunk;
+    }
+    chunk->pairs[chunk->count++] = (BodyPair){ first, second };
+}
+
+// Atualizar as acelerações dos corpos livres pela gravidade de todos os outros
+// (false se faltou memória do passo: as acelerações ficam sem atualizar)
+static bool updateGravitationalForces(Simulation* sim) {
+    Body* bodies = sim->bodies;
+    int count = sim->bodyCount;
+    double gravitationalFactor = sim->config.gravitationalFactor;
+    double minDistanceSq = sim->config.minDistanceSq;
+    bool collectPotential = sim->collectPotential;
+
+    // Posição de cada corpo e o peso do par no potencial, lado a lado em memória do
+    // passo: o laço dos pares lê 32 bytes por corpo em vez do Body inteiro
+    Arena* arena = stepArena(&sim->arenas);
+    int threads = arenaThreadCount();
+    double (*packed)[4] = arenaAlloc(arena, (size_t)count * sizeof(*packed));
+    PairChunk** threadPairs = arenaAlloc(arena, (size_t)threads * sizeof(PairChunk*));
+    if (!packed || !threadPairs) return false;
+    for (int t = 0; t < threads; t++) threadPairs[t] = NULL;
+
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN_BODIES)
+    for (int i = 0; i < count; i++) {
+        packed[i][0] = bodies[i].posX;
+        packed[i][1] = bodies[i].posY;
+        packed[i][2] = bodies[i].posZ;
+        packed[i][3] = bodies[i].kind != SIM_BODY_FREE ? 1.0 : 0.5;
+    }
+
+    // Calcular forças gravitacionais entre todos os pares de corpos (cada corpo
+    // só escreve a própria aceleração, então as linhas podem ir para threads diferentes)
+    double potential = 0.0;
+    #pragma omp parallel if (count >= PARALLEL_MIN_BODIES)
+    {
+        PairChunk* pairs = NULL;
+        Arena* pairArena = threadArena(&sim->arenas);
+
+        #pragma omp for schedule(static) reduction(+:potential)
+        for (int i = 0; i < count; i++) {
+            if (bodies[i].kind != SIM_BODY_FREE) continue; // Só os livres sofrem a gravidade
+
+            double x = packed[i][0], y = packed[i][1], z = packed[i][2];
+            double sumX = 0.0, sumY = 0.0, sumZ = 0.0;
+            for (int j = 0; j < count; j++) {
+                if (i == j) continue; // Pular auto-interação
+
+                // Calcular vetor distância entre os corpos em unidades GL
+                double dx = packed[j][0] - x;
+                double dy = packed[j][1] - y;
+                double dz = packed[j][2] - z;
+
+                // Distância ao quadrado em unidades GL
+                double distSq = dx*dx + dy*dy + dz*dz;
+
+                // Evitar divisão por zero ou forças muito grandes quando muito próximos.
+                // O par vira candidato a colisão (uma vez: o par de corpos livres passa
+                // aqui duas vezes, o par com um corpo que não é livre só uma).
+                if (distSq < minDistanceSq) {
+                    if (i < j || packed[j][3] == 1.0) addClosePair(&pairs, pairArena, i, j);
+                    continue;
+                }
+
+                // Calcular a distância real
+                double dist = sqrt(distSq);
+
+                // Potencial do par por unidade de massa, com o peso de cada par
+                if (collectPotential) {
+                    potential -= gravitationalFactor / dist * packed[j][3];
+                }
+
+                // Abordagem simplificada: aplicar força diretamente proporcional a 1/r²
+                double forceFactor = gravitationalFactor / (distSq);
+
+                // Componentes normalizados da aceleração, somados à do corpo i
+                sumX += dx / dist * forceFactor;
+                sumY += dy / dist * forceFactor;
+                sumZ += dz / dist * forceFactor;
+            }
+            bodies[i].accX = sumX;
+            bodies[i].accY = sumY;
+            bodies[i].accZ = sumZ;
+        }
+
+        threadPairs[arenaThreadIndex()] = pairs;
+    }
+    sim->potentialEnergy = potential;
+
+    // Junta as listas das threads em um vetor do passo
+    int pairCount = 0;
+    for (int t = 0; t < threads; t++) {
+        for (PairChunk* chunk = threadPairs[t]; chunk; chunk = chunk->next) {
+            pairCount += chunk->count;
+        }
+    }
+    sim->closePairs = arenaAlloc(arena, (size_t)pairCount * sizeof(BodyPair));
+    if (!sim->closePairs) return true; // As forças valem, só a lista de pares se perde
+    sim->closePairCount = pairCount;
+    int copied = 0;
+    for (int t = 0; t < threads; t++) {
+        for (PairChunk* chunk = threadPairs[t]; chunk; chunk = chunk->next) {
+            memcpy(sim->closePairs + copied, chunk->pairs, (size_t)chunk->count * sizeof(BodyPair));
+            copied += chunk->count;
+        }
+    }
+    return true;
+}
+
+// Energia, momento e momento angular do estado atual. A aceleração de cada corpo é
+// gravitationalFactor / r² sem depender das massas, o que equivale a todos terem a
+// mesma massa gravitacional: as grandezas conservadas são as por unidade de massa.
+static void measureConservation(Simulation* sim) {
+    const Body* bodies = sim->bodies;
+    SimConservation sample = { .time = sim->time, .potential = sim->potentialEnergy,
+                               .hasPotential = sim->collectPotential, .momentumConserved = true,
+                               .closePairs = sim->closePairCount };
+    double center[3] = { 0.0, 0.0, 0.0 };
+    int anchoredCount = 0;
+    for (int i = 0; i < sim->bodyCount; i++) {
+        if (bodies[i].kind == SIM_BODY_FREE) continue;
+        center[0] += bodies[i].posX;
+        center[1] += bodies[i].posY;
+        center[2] += bodies[i].posZ;
+        anchoredCount++;
+    }
+    if (anchoredCount > 0) {
+        for (int k = 0; k < 3; k++) center[k] /= anchoredCount;
+        sample.momentumConserved = false;
+    }
+
+    for (int i = 0; i < sim->bodyCount; i++) {
+        if (bodies[i].kind != SIM_BODY_FREE) continue;
+        double vx = bodies[i].velX, vy = bodies[i].velY, vz = bodies[i].velZ;
+        double rx = bodies[i].posX - center[0];
+        double ry = bodies[i].posY - center[1];
+        double rz = bodies[i].posZ - center[2];
+        double lx = ry * vz - rz * vy;
+        double ly = rz * vx - rx * vz;
+        double lz = rx * vy - ry * vx;
+
+        sample.kinetic += 0.5 * (vx * vx + vy * vy + vz * vz);
+        sample.momentum[0] += vx;
+        sample.momentum[1] += vy;
+        sample.momentum[2] += vz;
+        sample.angularMomentum[0] += lx;
+        sample.angularMomentum[1] += ly;
+        sample.angularMomentum[2] += lz;
+        sample.momentumScale += sqrt(vx * vx + vy * vy + vz * vz);
+        sample.angularMomentumScale += sqrt(lx * lx + ly * ly + lz * lz);
+    }
+    sim->lastSample = sample;
+    sim->hasSample = true;
+}
+
+// Ângulo em [0, 360), para velocidades positivas ou negativas (fmodf é exato, então
+// quem já estava no intervalo não muda)
+static float wrapDegrees(float angle) {
+    if (angle >= 360.0f || angle < 0.0f) {
+        angle = fmodf(angle, 360.0f);
+        if (angle < 0.0f) angle += 360.0f;
+    }
+    return angle;
+}
+
+// Avançar as anomalias médias e as rotações e reposicionar os corpos em órbita
+// (pais antes dos filhos)
+static void updateOrbits(Simulation* sim) {
+    float timeStep = (float)sim->config.timeStep;
+    for (int i = 0; i < sim->bodyCount; i++) {
+        Body* body = &sim->bodies[i];
+        if (body->kind == SIM_BODY_ORBIT) {
+            // Avançar a anomalia média deste corpo
+            if (body->orbitalSpeed != 0.0f) {
+                body->meanAnomaly += body->orbitalSpeed * timeStep * sim->config.orbitTimeScale;
+                body->meanAnomaly = wrapDegrees(body->meanAnomaly);
+            }
+
+            // Nova posição na órbita ao redor do pai e a velocidade média do passo
+            double previous[3] = { body->posX, body->posY, body->posZ };
+            updateOrbitalPosition(sim, body);
+            if (timeStep > 0.0f) {
+                body->velX = (body->posX - previous[0]) / timeStep;
+                body->velY = (body->posY - previous[1]) / timeStep;
+                body->velZ = (body->posZ - previous[2]) / timeStep;
+            }
+        }
+
+        // Também atualizar a rotação do próprio corpo
+        body->rotationAngle += body->rotationSpeed * timeStep;
+        body->rotationAngle = wrapDegrees(body->rotationAngle);
+    }
+}
+
+static void integrate(Simulation* sim) {
+    Body* bodies = sim->bodies;
+    int count = sim->bodyCount;
+    double timeStep = sim->config.timeStep;
+
+    // Atualizar velocidades e posições usando as acelerações calculadas
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN_BODIES)
+    for (int i = 0; i < count; i++) {
+        if (bodies[i].kind != SIM_BODY_FREE) continue; // Só os livres se movem pela gravidade
+
+        // Atualizar velocidade com base na aceleração (v = v + a*t)
+        bodies[i].velX += bodies[i].accX * timeStep;
+        bodies[i].velY += bodies[i].accY * timeStep;
+        bodies[i].velZ += bodies[i].accZ * timeStep;
+
+        // Atualizar posição com base na velocidade (p = p + v*t)
+        bodies[i].posX += bodies[i].velX * timeStep;
+        bodies[i].posY += bodies[i].velY * timeStep;
+        bodies[i].posZ += bodies[i].velZ * timeStep;
+    }
+}
+
+// false se o passo ficou sem forças (os corpos livres não foram integrados nele)
+static bool stepOnce(Simulation* sim) {
+    // Os dados temporários do passo anterior deixam de valer
+    beginStepArenas(&sim->arenas);
+    sim->closePairs = NULL;
+    sim->closePairCount = 0;
+    sim->potentialEnergy = 0.0;
+
+    // A ordem dos corpos só muda a soma das forças nos últimos bits
+    int interval = sim->config.reorderInterval;
+    if (interval > 0 && sim->orbitCount == 0 && sim->bodyCount >= SIM_REORDER_MIN_BODIES &&
+        sim->steps % (uint64_t)interval == 0) {
+        beginPhase(sim, "reordenacao");
+        reorderBodies(sim);
+        endPhase(sim);
+    }
+    sim->steps++;
+
+    if (sim->orbitCount > 0 || sim->spinningCount > 0) {
+        beginPhase(sim, "posicoes");
+        updateOrbits(sim);
+        endPhase(sim);
+    }
+
+    // Forças gravitacionais (e a energia potencial, se a medição pedir). Sem elas
+    // as acelerações seriam as do passo anterior: os corpos livres ficam parados
+    // neste passo, que não é medido. Os em órbita já avançaram, então o tempo também.
+    if (sim->freeCount > 0) {
+        beginPhase(sim, "forcas");
+        bool forces = updateGravitationalForces(sim);
+        endPhase(sim);
+        if (!forces) {
+            sim->time += sim->config.timeStep;
+            return false;
+        }
+    }
+
+    // Grandezas conservadas no estado de antes da integração, o mesmo das forças
+    if (sim->measureConservation) {
+        beginPhase(sim, "conservacao");
+        measureConservation(sim);
+        endPhase(sim);
+    }
+
+    if (sim->freeCount > 0) {
+        beginPhase(sim, "integracao");
+        integrate(sim);
+        endPhase(sim);
+    }
+    sim->time += sim->config.timeStep;
+    return true;
+}
+
+bool simStep(Simulation* sim, int steps) {
+    for (int s = 0; s < steps; s++) {
+        if (!stepOnce(sim)) return false;
+    }
+    return true;
+}
+
+int simBodyCount(const Simulation* sim) {
+    return sim->bodyCount;
+}
+
+double simTime(const Simulation* sim) {
+    return sim->time;
+}
+
+uint64_t simStepCount(const Simulation* sim) {
+    return sim->steps;
+}
+
+double simTimeStep(const Simulation* sim) {
+    return sim->config.timeStep;
+}
+
+void simSetTimeStep(Simulation* sim, double timeStep) {
+    sim->config.timeStep = timeStep;
+}
+
+int simGetState(const Simulation* sim, SimBodyState* out, int capacity) {
+    int count = sim->bodyCount < capacity ? sim->bodyCount : capacity;
+    #pragma omp parallel for schedule(static) if (count >= PARALLEL_MIN_BODIES)
+    for (int id = 0; id < count; id++) {
+        const Body* body = &sim->bodies[sim->indexById[id]];
+        out[id] = (SimBodyState){
+            .position = { body->posX, body->posY, body->posZ },
+            .velocity = { body->velX, body->velY, body->velZ },
+            .rotationAngle = body->rotationAngle,
+            .kind = body->kind
+        };
+    }
+    return count;
+}
+
+int simGetClosePairs(const Simulation* sim, int (*pairs)[2], int capacity) {
+    for (int p = 0; p < sim->closePairCount && p < capacity; p++) {
+        pairs[p][0] = sim->bodies[sim->closePairs[p].first].id;
+        pairs[p][1] = sim->bodies[sim->closePairs[p].second].id;
+    }
+    return sim->closePairCount;
+}
+
+void simSetMeasurement(Simulation* sim, bool conservation, bool potential) {
+    sim->measureConservation = conservation;
+    sim->collectPotential = potential;
+}
+
+bool simLastConservation(const Simulation* sim, SimConservation* out) {
+    if (!sim->hasSample) return false;
+    *out = sim->lastSample;
+    return true;
+}
+
+void simSetPhaseHooks(Simulation* sim, void (*begin)(const char* phase), void (*end)(void)) {
+    sim->phaseBegin = begin;
+    sim->phaseEnd = end;
+}
+
+size_t simMemoryBytes(const Simulation* sim) {
+    return sizeof(Simulation) + (size_t)sim->capacity * (sizeof(Body) + sizeof(int));
+}
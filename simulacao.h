@@ -0,0 +1,143 @@
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Núcleo da simulação (libsistemasolar), sem OpenGL nem variáveis globais: todo o
+// estado fica em um Simulation criado por simCreate, então vários podem rodar no
+// mesmo processo, cada um na sua thread (uma mesma simulação não pode ser usada
+// por duas threads ao mesmo tempo). Os dois programas desenham o estado lido daqui.
+//
+// Há três tipos de corpo:
+// - livre: integrado pela gravidade de todos os outros corpos (aceleração
+//   gravitationalFactor / r², sem depender das massas);
+// - fixo: parado, mas atrai os livres;
+// - em órbita: segue uma órbita kepleriana em torno do pai, sem sofrer gravidade
+//   (também atrai os livres).
+//
+// Cada corpo tem um id, a ordem em que foi adicionado. Os vetores de estado são
+// sempre indexados pelo id, mesmo que a simulação reordene os corpos por dentro.
+
+typedef struct Simulation Simulation;
+
+// Elementos de uma órbita kepleriana (ângulos em graus)
+typedef struct {
+    float semiMajorAxis;   // Semi-eixo maior (0 = o corpo fica sobre o pai)
+    float eccentricity;    // 0 = círculo, < 1 = elipse
+    float inclination;     // Em relação ao plano XZ (Y é o eixo "para cima")
+    float ascendingNode;   // Longitude do nodo ascendente
+    float argPeriapsis;    // Argumento do periastro
+} SimOrbit;
+
+typedef enum {
+    SIM_BODY_FREE,
+    SIM_BODY_FIXED,
+    SIM_BODY_ORBIT
+} SimBodyKind;
+
+typedef struct {
+    SimBodyKind kind;
+    double position[3];    // Livres e fixos
+    double velocity[3];    // Livres
+    double mass;           // Em kg (só informativa: a gravidade não usa)
+    // Em órbita: elementos em relação ao pai, que precisa ter sido adicionado antes
+    SimOrbit orbit;
+    int parent;            // Id do pai, -1 = em torno da origem
+    float meanAnomaly;     // Anomalia média inicial em graus
+    float orbitalSpeed;    // Graus por unidade de tempo
+    float rotationSpeed;   // Rotação em torno do próprio eixo, graus por unidade de tempo
+} SimBody;
+
+// Estado de um corpo lido com simGetState
+typedef struct {
+    double position[3];
+    double velocity[3];    // Nos corpos em órbita, a média do último passo
+    float rotationAngle;   // Graus, em [0, 360)
+    SimBodyKind kind;
+} SimBodyState;
+
+typedef struct {
+    double timeStep;             // Tempo simulado por passo
+    double gravitationalFactor;  // Aceleração a uma unidade de distância
+    double minDistanceSq;        // Pares mais próximos que isto não se atraem (pares próximos)
+    float orbitTimeScale;        // Multiplica o avanço das anomalias médias
+    int reorderInterval;         // Passos entre reordenações pela chave de Morton (0 desliga)
+} SimulationConfig;
+
+#define SIM_DEFAULT_TIME_STEP 0.01
+#define SIM_DEFAULT_GRAVITATIONAL_FACTOR 50.0
+#define SIM_DEFAULT_MIN_DISTANCE_SQ 0.1
+#define SIM_DEFAULT_REORDER_INTERVAL 64
+
+// Abaixo disso a reordenação só custaria tempo: tudo já cabe no cache
+#define SIM_REORDER_MIN_BODIES 1024
+
+// Configuração padrão (a da simulação gravitacional)
+SimulationConfig simDefaultConfig(void);
+
+// Grandezas conservadas por unidade de massa, no estado antes da integração do
+// último passo. O momento angular é medido em torno do centro dos corpos que não
+// são livres (que absorvem momento linear: momentumConserved fica falso).
+typedef struct {
+    double time;
+    double kinetic;
+    double potential;              // Só vale com hasPotential
+    bool hasPotential;
+    double momentum[3];
+    double angularMomentum[3];
+    double momentumScale;          // Soma dos módulos, para a deriva quando o total é ~0
+    double angularMomentumScale;
+    bool momentumConserved;
+    int closePairs;                // Pares sem força por estarem próximos demais
+} SimConservation;
+
+// NULL sem memória (config NULL = simDefaultConfig)
+Simulation* simCreate(const SimulationConfig* config);
+void simDestroy(Simulation* sim);
+
+// Adiciona um corpo e devolve o id dele (-1 sem memória ou com pai inválido)
+int simAddBody(Simulation* sim, const SimBody* body);
+
+// Avança steps passos. Retorna false se faltou memória para as forças de um passo:
+// nele os corpos livres ficaram parados (sem acelerações velhas) e os passos
+// restantes não foram dados.
+bool simStep(Simulation* sim, int steps);
+
+int simBodyCount(const Simulation* sim);
+double simTime(const Simulation* sim);
+uint64_t simStepCount(const Simulation* sim);
+
+double simTimeStep(const Simulation* sim);
+void simSetTimeStep(Simulation* sim, double timeStep);
+
+// Copia o estado dos corpos para out, indexado pelo id (até capacity corpos).
+// Retorna quantos foram copiados.
+int simGetState(const Simulation* sim, SimBodyState* out, int capacity);
+
+// Pares próximos demais do último passo, como ids (candidatos a colisão). Copia
+// até capacity e retorna o total.
+int simGetClosePairs(const Simulation* sim, int (*pairs)[2], int capacity);
+
+// Medição das grandezas conservadas nos próximos passos (potential soma também a
+// energia potencial, no próprio laço das forças)
+void simSetMeasurement(Simulation* sim, bool conservation, bool potential);
+
+// Grandezas do último passo medido (false se nenhum foi)
+bool simLastConservation(const Simulation* sim, SimConservation* out);
+
+// Funções chamadas no início e no fim de cada fase do passo ("posicoes", "forcas",
+// "integracao"...), para quem quiser medi-las. NULL desliga.
+void simSetPhaseHooks(Simulation* sim, void (*begin)(const char* phase), void (*end)(void));
+
+// Memória ocupada pelos corpos e índices da simulação (sem as arenas do passo)
+size_t simMemoryBytes(const Simulation* sim);
+
+// Equação de Kepler M = E - e sin(E): anomalia excêntrica (radianos) da média M
+float simSolveKepler(float meanAnomaly, float eccentricity);
+
+// Posição na órbita para uma anomalia excêntrica (radianos), com o foco na origem
+void simOrbitPosition(const SimOrbit* orbit, float eccentricAnomaly, float out[3]);
+
+#endif
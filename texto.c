@@ -0,0 +1,485 @@
+#include "texto.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memoria.h"
+
+// Fonte bitmap 8x8 (domínio público, font8x8_basic) para os caracteres ASCII 32 a 126.
+// Cada byte é uma linha do glifo, de cima para baixo; o bit 0 é o pixel mais à esquerda.
+static const unsigned char font8x8[95][8] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 }, // '!'
+    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 }, // '#'
+    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 }, // '$'
+    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 }, // '%'
+    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 }, // '&'
+    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '''
+    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 }, // '('
+    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 }, // ')'
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 }, // '*'
+    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 }, // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ','
+    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 }, // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // '.'
+    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 }, // '/'
+    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 }, // '0'
+    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 }, // '1'
+    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 }, // '2'
+    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 }, // '3'
+    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 }, // '4'
+    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 }, // '5'
+    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 }, // '6'
+    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 }, // '7'
+    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 }, // '8'
+    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 }, // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ';'
+    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 }, // '<'
+    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 }, // '='
+    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 }, // '>'
+    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 }, // '?'
+    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 }, // '@'
+    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 }, // 'A'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 }, // 'B'
+    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 }, // 'C'
+    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 }, // 'D'
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 }, // 'E'
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 }, // 'F'
+    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 }, // 'G'
+    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 }, // 'H'
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'I'
+    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 }, // 'J'
+    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 }, // 'K'
+    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 }, // 'L'
+    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 }, // 'M'
+    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 }, // 'N'
+    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 }, // 'O'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 }, // 'P'
+    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 }, // 'Q'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 }, // 'R'
+    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 }, // 'S'
+    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'T'
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 }, // 'U'
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // 'V'
+    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 }, // 'W'
+    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 }, // 'X'
+    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 }, // 'Y'
+    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 }, // 'Z'
+    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 }, // '['
+    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 }, // '\'
+    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 }, // ']'
+    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 }, // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }, // '_'
+    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '`'
+    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 }, // 'a'
+    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 }, // 'b'
+    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 }, // 'c'
+    { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 }, // 'd'
+    { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 }, // 'e'
+    { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 }, // 'f'
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // 'g'
+    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 }, // 'h'
+    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'i'
+    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E }, // 'j'
+    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 }, // 'k'
+    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'l'
+    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 }, // 'm'
+    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 }, // 'n'
+    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 }, // 'o'
+    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F }, // 'p'
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 }, // 'q'
+    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 }, // 'r'
+    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 }, // 's'
+    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 }, // 't'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 }, // 'u'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // 'v'
+    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 }, // 'w'
+    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 }, // 'x'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // 'y'
+    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 }, // 'z'
+    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 }, // '{'
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // '|'
+    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 }, // '}'
+    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }  // '~'
+};
+
+#define FIRST_GLYPH 32
+#define GLYPH_COUNT 95
+
+// Layout do atlas: 16 colunas x 6 linhas, cada glifo ampliado 2x em uma célula de 16x16
+#define ATLAS_COLUMNS 16
+#define ATLAS_ROWS 6
+#define GLYPH_PIXELS 8
+#define GLYPH_UPSCALE 2
+#define CELL_SIZE (GLYPH_PIXELS * GLYPH_UPSCALE)
+#define ATLAS_WIDTH (ATLAS_COLUMNS * CELL_SIZE)
+#define ATLAS_HEIGHT (ATLAS_ROWS * CELL_SIZE)
+
+// Tamanho de um pixel da fonte em unidades GL (glifo de 8x8 pixels = 1.6 unidades)
+#define LABEL_PIXEL_SIZE 0.2f
+
+// Cada vértice de rótulo guarda posição (x, y, z) e coordenada de textura (u, v)
+#define LABEL_VERTEX_FLOATS 5
+
+// Texto na tela: glifos de 8x8 pixels, linhas a cada 10 pixels
+#define SCREEN_LINE_HEIGHT 10
+#define SCREEN_MARGIN 4
+
+// Quad de um glifo no espaço local do rótulo (x para a direita, y para cima)
+typedef struct {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+} GlyphQuad;
+
+// Rótulo com seus quads já calculados
+typedef struct {
+    GlyphQuad* quads;
+    int quadCount;
+} Label;
+
+// Rótulo enfileirado para o quadro atual
+typedef struct {
+    int label;
+    float x, y, z;
+} QueuedLabel;
+
+static GLuint atlasTexture = 0;
+static GLuint labelVBO = 0;
+static size_t labelBufferBytes = 0; // Contados em MEMORY_MESHES
+
+static Label* labels = NULL;
+static int labelCount = 0;
+static int labelCapacity = 0;
+
+static QueuedLabel* queue = NULL;
+static int queueCount = 0;
+static int queueCapacity = 0;
+
+// Vértices gerados no quadro atual antes do envio ao buffer
+static float* vertices = NULL;
+static size_t vertexCapacity = 0;
+
+void initTextRenderer(void) {
+    unsigned char* atlas = calloc(ATLAS_WIDTH * ATLAS_HEIGHT, 1);
+    if (!atlas) {
+        fprintf(stderr, "Erro: Falha ao alocar memória para o atlas de glifos.\n");
+        return;
+    }
+
+    // Rasterizar cada glifo na sua célula (linha 0 da textura fica embaixo)
+    for (int g = 0; g < GLYPH_COUNT; g++) {
+        int cellX = (g % ATLAS_COLUMNS) * CELL_SIZE;
+        int cellY = (g / ATLAS_COLUMNS) * CELL_SIZE;
+        for (int row = 0; row < GLYPH_PIXELS; row++) {
+            for (int col = 0; col < GLYPH_PIXELS; col++) {
+                if (!(font8x8[g][row] & (1 << col))) continue;
+                for (int dy = 0; dy < GLYPH_UPSCALE; dy++) {
+                    for (int dx = 0; dx < GLYPH_UPSCALE; dx++) {
+                        int px = cellX + col * GLYPH_UPSCALE + dx;
+                        int py = cellY + CELL_SIZE - 1 - (row * GLYPH_UPSCALE + dy);
+                        atlas[py * ATLAS_WIDTH + px] = 255;
+                    }
+                }
+            }
+        }
+    }
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_WIDTH, ATLAS_HEIGHT, 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, atlas);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    trackMemory(MEMORY_TEXTURE_GL, ATLAS_WIDTH * ATLAS_HEIGHT);
+    free(atlas);
+
+    glGenBuffers(1, &labelVBO);
+}
+
+int createLabel(const char* text) {
+    if (labelCount == labelCapacity) {
+        int newCapacity = labelCapacity ? labelCapacity * 2 : 16;
+        Label* newLabels = realloc(labels, newCapacity * sizeof(Label));
+        if (!newLabels) {
+            fprintf(stderr, "Erro: Falha ao alocar memória para os rótulos.\n");
+            return -1;
+        }
+        labels = newLabels;
+        labelCapacity = newCapacity;
+    }
+
+    int length = (int)strlen(text);
+    Label* label = &labels[labelCount];
+    label->quads = malloc((length > 0 ? length : 1) * sizeof(GlyphQuad));
+    label->quadCount = 0;
+    if (!label->quads) {
+        fprintf(stderr, "Erro: Falha ao alocar memória para os rótulos.\n");
+        return -1;
+    }
+
+    // Meio texel de margem para o filtro linear não pegar a célula vizinha
+    float halfTexelU = 0.5f / ATLAS_WIDTH;
+    float halfTexelV = 0.5f / ATLAS_HEIGHT;
+
+    for (int i = 0; i < length; i++) {
+        int c = (unsigned char)text[i];
+        if (c == ' ') continue; // Espaços só avançam a posição
+        if (c < FIRST_GLYPH || c >= FIRST_GLYPH + GLYPH_COUNT) c = '?';
+        int g = c - FIRST_GLYPH;
+
+        GlyphQuad* q = &label->quads[label->quadCount++];
+        q->x0 = i * GLYPH_PIXELS * LABEL_PIXEL_SIZE;
+        q->x1 = q->x0 + GLYPH_PIXELS * LABEL_PIXEL_SIZE;
+        q->y0 = 0.0f;
+        q->y1 = GLYPH_PIXELS * LABEL_PIXEL_SIZE;
+        q->u0 = (float)((g % ATLAS_COLUMNS) * CELL_SIZE) / ATLAS_WIDTH + halfTexelU;
+        q->u1 = (float)((g % ATLAS_COLUMNS + 1) * CELL_SIZE) / ATLAS_WIDTH - halfTexelU;
+        q->v0 = (float)((g / ATLAS_COLUMNS) * CELL_SIZE) / ATLAS_HEIGHT + halfTexelV;
+        q->v1 = (float)((g / ATLAS_COLUMNS + 1) * CELL_SIZE) / ATLAS_HEIGHT - halfTexelV;
+    }
+
+    return labelCount++;
+}
+
+void queueLabel(int label, float x, float y, float z) {
+    if (label < 0 || label >= labelCount) return;
+
+    if (queueCount == queueCapacity) {
+        int newCapacity = queueCapacity ? queueCapacity * 2 : 16;
+        QueuedLabel* newQueue = realloc(queue, newCapacity * sizeof(QueuedLabel));
+        if (!newQueue) return;
+        queue = newQueue;
+        queueCapacity = newCapacity;
+    }
+
+    QueuedLabel* q = &queue[queueCount++];
+    q->label = label;
+    q->x = x;
+    q->y = y;
+    q->z = z;
+}
+
+// Garante espaço para floatCount floats no buffer de vértices do quadro
+static bool reserveVertices(size_t floatCount) {
+    if (floatCount <= vertexCapacity) return true;
+    float* newVertices = realloc(vertices, floatCount * sizeof(float));
+    if (!newVertices) return false;
+    vertices = newVertices;
+    vertexCapacity = floatCount;
+    return true;
+}
+
+// Escreve um vértice do rótulo: âncora + x * right + y * up
+static float* writeLabelVertex(float* v, const QueuedLabel* q, float x, float y, float u, float t,
+                               const float right[3], const float up[3]) {
+    v[0] = q->x + x * right[0] + y * up[0];
+    v[1] = q->y + x * right[1] + y * up[1];
+    v[2] = q->z + x * right[2] + y * up[2];
+    v[3] = u;
+    v[4] = t;
+    return v + LABEL_VERTEX_FLOATS;
+}
+
+void drawQueuedLabels(const float right[3], const float up[3]) {
+    if (atlasTexture == 0 || queueCount == 0) {
+        queueCount = 0;
+        return;
+    }
+
+    // Contar os quads do quadro e garantir espaço no buffer de vértices
+    size_t quadTotal = 0;
+    for (int i = 0; i < queueCount; i++) {
+        quadTotal += labels[queue[i].label].quadCount;
+    }
+    size_t needed = quadTotal * 4 * LABEL_VERTEX_FLOATS;
+    if (!reserveVertices(needed)) {
+        queueCount = 0;
+        return;
+    }
+
+    // Billboarding na CPU: expandir os quads em cache ao longo dos eixos da câmera
+    float* v = vertices;
+    for (int i = 0; i < queueCount; i++) {
+        const QueuedLabel* q = &queue[i];
+        const Label* label = &labels[q->label];
+        for (int j = 0; j < label->quadCount; j++) {
+            const GlyphQuad* g = &label->quads[j];
+            v = writeLabelVertex(v, q, g->x0, g->y0, g->u0, g->v0, right, up);
+            v = writeLabelVertex(v, q, g->x1, g->y0, g->u1, g->v0, right, up);
+            v = writeLabelVertex(v, q, g->x1, g->y1, g->u1, g->v1, right, up);
+            v = writeLabelVertex(v, q, g->x0, g->y1, g->u0, g->v1, right, up);
+        }
+    }
+    queueCount = 0;
+
+    // Enviar os vértices (descartando o conteúdo anterior do buffer)
+    GLsizeiptr bytes = (GLsizeiptr)(needed * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, labelVBO);
+    glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    trackMemorySize(MEMORY_MESHES, &labelBufferBytes, (size_t)bytes);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices);
+
+    // Texto branco com transparência vinda do atlas
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.1f);
+    glColor3f(1.0f, 1.0f, 1.0f);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, LABEL_VERTEX_FLOATS * sizeof(float), (const void*)0);
+    glTexCoordPointer(2, GL_FLOAT, LABEL_VERTEX_FLOATS * sizeof(float), (const void*)(3 * sizeof(float)));
+
+    glDrawArrays(GL_QUADS, 0, (GLsizei)(quadTotal * 4));
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_ALPHA_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_TEXTURE_2D);
+}
+
+static float* writeScreenVertex(float* v, float x, float y, float u, float t) {
+    v[0] = x;
+    v[1] = y;
+    v[2] = 0.0f;
+    v[3] = u;
+    v[4] = t;
+    return v + LABEL_VERTEX_FLOATS;
+}
+
+void drawScreenText(const char* text, int x, int y, int viewportWidth, int viewportHeight) {
+    if (atlasTexture == 0) return;
+
+    // Um quad de fundo mais um por caractere visível
+    size_t length = strlen(text);
+    if (!reserveVertices((length + 1) * 4 * LABEL_VERTEX_FLOATS)) return;
+
+    float halfTexelU = 0.5f / ATLAS_WIDTH;
+    float halfTexelV = 0.5f / ATLAS_HEIGHT;
+    float* v = vertices + 4 * LABEL_VERTEX_FLOATS; // O fundo é escrito no fim
+    int column = 0, line = 0, widest = 0;
+    for (size_t i = 0; i < length; i++) {
+        int c = (unsigned char)text[i];
+        if (c == '\n') {
+            line++;
+            column = 0;
+            continue;
+        }
+        column++;
+        if (column > widest) widest = column;
+        if (c == ' ') continue;
+        if (c < FIRST_GLYPH || c >= FIRST_GLYPH + GLYPH_COUNT) c = '?';
+        int g = c - FIRST_GLYPH;
+
+        // y da tela cresce para cima no OpenGL
+        float x0 = (float)(x + (column - 1) * GLYPH_PIXELS);
+        float x1 = x0 + GLYPH_PIXELS;
+        float y1 = (float)(viewportHeight - y - line * SCREEN_LINE_HEIGHT);
+        float y0 = y1 - GLYPH_PIXELS;
+        float u0 = (float)((g % ATLAS_COLUMNS) * CELL_SIZE) / ATLAS_WIDTH + halfTexelU;
+        float u1 = (float)((g % ATLAS_COLUMNS + 1) * CELL_SIZE) / ATLAS_WIDTH - halfTexelU;
+        float t0 = (float)((g / ATLAS_COLUMNS) * CELL_SIZE) / ATLAS_HEIGHT + halfTexelV;
+        float t1 = (float)((g / ATLAS_COLUMNS + 1) * CELL_SIZE) / ATLAS_HEIGHT - halfTexelV;
+        v = writeScreenVertex(v, x0, y0, u0, t0);
+        v = writeScreenVertex(v, x1, y0, u1, t0);
+        v = writeScreenVertex(v, x1, y1, u1, t1);
+        v = writeScreenVertex(v, x0, y1, u0, t1);
+    }
+    GLsizei glyphVertices = (GLsizei)((v - vertices) / LABEL_VERTEX_FLOATS) - 4;
+
+    // Fundo cobrindo todas as linhas
+    float left = (float)(x - SCREEN_MARGIN);
+    float right = (float)(x + widest * GLYPH_PIXELS + SCREEN_MARGIN);
+    float top = (float)(viewportHeight - y + SCREEN_MARGIN);
+    float bottom = (float)(viewportHeight - y - line * SCREEN_LINE_HEIGHT - GLYPH_PIXELS - SCREEN_MARGIN);
+    float* b = vertices;
+    b = writeScreenVertex(b, left, bottom, 0.0f, 0.0f);
+    b = writeScreenVertex(b, right, bottom, 0.0f, 0.0f);
+    b = writeScreenVertex(b, right, top, 0.0f, 0.0f);
+    writeScreenVertex(b, left, top, 0.0f, 0.0f);
+
+    GLsizeiptr bytes = (GLsizeiptr)((v - vertices) * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, labelVBO);
+    glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    trackMemorySize(MEMORY_MESHES, &labelBufferBytes, (size_t)bytes);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices);
+
+    // Projeção em pixels, sem profundidade nem iluminação
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, viewportWidth, 0.0, viewportHeight, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, LABEL_VERTEX_FLOATS * sizeof(float), (const void*)0);
+    glTexCoordPointer(2, GL_FLOAT, LABEL_VERTEX_FLOATS * sizeof(float), (const void*)(3 * sizeof(float)));
+
+    glDisable(GL_TEXTURE_2D);
+    glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+    glDrawArrays(GL_QUADS, 0, 4);
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glDrawArrays(GL_QUADS, 4, glyphVertices);
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+}
+
+void freeTextRenderer(void) {
+    if (atlasTexture != 0) {
+        glDeleteTextures(1, &atlasTexture);
+        atlasTexture = 0;
+        trackMemory(MEMORY_TEXTURE_GL, -ATLAS_WIDTH * ATLAS_HEIGHT);
+    }
+    if (labelVBO != 0) {
+        glDeleteBuffers(1, &labelVBO);
+        labelVBO = 0;
+        trackMemorySize(MEMORY_MESHES, &labelBufferBytes, 0);
+    }
+    for (int i = 0; i < labelCount; i++) {
+        free(labels[i].quads);
+    }
+    free(labels);
+    free(queue);
+    free(vertices);
+    labels = NULL;
+    queue = NULL;
+    vertices = NULL;
+    labelCount = labelCapacity = 0;
+    queueCount = queueCapacity = 0;
+    vertexCapacity = 0;
+}
@@ -0,0 +1,27 @@
+#ifndef TEXTO_H
+#define TEXTO_H
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+
+// Cria o atlas de glifos (fonte bitmap 8x8) em uma textura. Chamar após criar o contexto GL.
+void initTextRenderer(void);
+
+// Gera e guarda os quads de um rótulo. Retorna o identificador do rótulo ou -1 em caso de erro.
+int createLabel(const char* text);
+
+// Enfileira um rótulo para ser desenhado neste quadro com o canto inferior esquerdo em (x, y, z)
+void queueLabel(int label, float x, float y, float z);
+
+// Desenha todos os rótulos enfileirados em uma única chamada, virados para a câmera.
+// right e up são os eixos da câmera em coordenadas do mundo.
+void drawQueuedLabels(const float right[3], const float up[3]);
+
+// Desenha texto fixo na tela (linhas separadas por '\n') sobre um fundo escuro, com o
+// canto superior esquerdo em (x, y) pixels a partir do canto superior esquerdo
+void drawScreenText(const char* text, int x, int y, int viewportWidth, int viewportHeight);
+
+// Libera o atlas, os buffers e o cache de rótulos
+void freeTextRenderer(void);
+
+#endif
@@ -0,0 +1,786 @@
+#include "textura.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <GL/glext.h>
+
+#include "catalogo.h"
+#include "estado_gl.h"
+#include "memoria.h"
+#include "rastro.h"
+
+#define MAX_TEXTURE_LEVELS 16
+#define MAX_TEXTURE_THREADS 16
+#define TEXTURE_WORKER_NICE 10
+
+// Largura máxima da miniatura enviada assim que a textura é decodificada
+#define TEXTURE_THUMBNAIL_SIZE 64
+
+// Bytes enviados ao OpenGL por quadro (um nível maior que isso vai sozinho)
+#define TEXTURE_UPLOAD_BUDGET (2 * 1024 * 1024)
+
+// Estado da decodificação, escrito pelas threads e lido pela thread do OpenGL
+enum {
+    TEXTURE_PENDING,
+    TEXTURE_DECODED,
+    TEXTURE_FAILED
+};
+
+// Cache em disco com a cadeia de mipmaps já pronta, um arquivo por textura
+#define TEXTURE_CACHE_DIR ".cache_texturas"
+#define TEXTURE_CACHE_MAGIC 0x58545353u // "SSTX"
+#define TEXTURE_CACHE_VERSION 1
+
+// Cabeçalho do arquivo de cache, seguido pelos níveis em sequência. A chave é o
+// caminho, a data de modificação e o tamanho do arquivo de origem: se qualquer um
+// mudar, o cache é refeito.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    char sourcePath[CATALOG_PATH_LENGTH];
+    int64_t sourceMtime;
+    int64_t sourceSize;
+    int32_t channels;
+    int32_t levelCount;
+    int32_t levelWidth[MAX_TEXTURE_LEVELS];
+    int32_t levelHeight[MAX_TEXTURE_LEVELS];
+    uint64_t dataSize;
+} TextureCacheHeader;
+
+// Uma textura: arquivo de origem, onde ela fica no OpenGL (textura própria ou camada
+// de um array) e, depois de decodificada, todos os níveis de mipmap em um único bloco
+// de memória. Os níveis são enviados do menor para o maior, só até o detalhe pedido
+// pelos corpos que usam a textura.
+typedef struct {
+    char path[CATALOG_PATH_LENGTH];
+    GLuint id;             // Textura própria (0 se estiver em um array)
+    int array;             // Índice do array de superfícies, -1 se não estiver em um
+    int layer;             // Camada dentro do array
+    int infoWidth;         // Dimensões lidas do cabeçalho do arquivo no registro
+    int infoHeight;
+    int infoChannels;
+    atomic_int state;
+    bool prepared;         // A thread do OpenGL já tratou o resultado da decodificação
+    int residentLevel;     // Nível mais detalhado já enviado (levelCount = nenhum)
+    int baseLevel;         // Primeiro nível que cabe no limite de tamanho da placa
+    float wantedPixels;    // Maior diâmetro na tela pedido neste quadro
+    int channels;
+    int levelCount;
+    int levelWidth[MAX_TEXTURE_LEVELS];
+    int levelHeight[MAX_TEXTURE_LEVELS];
+    size_t levelOffset[MAX_TEXTURE_LEVELS];
+    unsigned char* pixels; // NULL se a decodificação falhou
+    void* mapping;         // Arquivo de cache mapeado (pixels aponta para dentro dele)
+    size_t mappingSize;
+    size_t stagingBytes;   // Quanto de pixels/mapping está contado na memória
+    bool cacheMissing;     // Não há cache para reler níveis descartados pelo orçamento
+} TextureJob;
+
+// Texturas de mesmo tamanho e formato compartilham um GL_TEXTURE_2D_ARRAY, uma
+// camada por arquivo, para os corpos serem desenhados sem trocar de textura
+typedef struct {
+    GLuint id;
+    int width, height, channels;
+    int layers;
+    int levelCount;
+    int baseLevel;
+    int allocatedLevel;    // Nível mais detalhado já reservado (levelCount = nenhum)
+    int levelWidth[MAX_TEXTURE_LEVELS];
+    int levelHeight[MAX_TEXTURE_LEVELS];
+} SurfaceArray;
+
+static SurfaceArray* surfaceArrays = NULL;
+static int surfaceArrayCount = 0;
+
+static TextureJob* textures = NULL;
+static int textureCount = 0;
+static int textureCapacity = 0;
+static bool loadingStarted = false;
+static int finishedCount = 0;      // Texturas já decodificadas ou com erro
+static struct timespec loadingStart;
+static bool uploadAllLevels = false; // Ignorar pedidos e orçamento (finishTextureLoading)
+static size_t memoryBudget = 0;      // Bytes de textura no OpenGL, 0 = sem limite
+static int evictedLevels = 0;
+
+// Fila de trabalho compartilhada pelas threads
+static atomic_int nextJob;
+
+int requestTexture(const char* path) {
+    if (path[0] == '\0') return 0;
+    if (loadingStarted) {
+        fprintf(stderr, "Aviso: Textura %s registrada após o início do carregamento\n", path);
+        return 0;
+    }
+
+    for (int i = 0; i < textureCount; i++) {
+        if (strcmp(textures[i].path, path) == 0) {
+            return i + 1;
+        }
+    }
+
+    if (textureCount == textureCapacity) {
+        int newCapacity = textureCapacity ? textureCapacity * 2 : 16;
+        TextureJob* newList = realloc(textures, newCapacity * sizeof(TextureJob));
+        if (!newList) return 0;
+        textures = newList;
+        textureCapacity = newCapacity;
+    }
+
+    TextureJob* job = &textures[textureCount++];
+    memset(job, 0, sizeof(*job));
+    strcpy(job->path, path);
+    job->array = -1;
+    atomic_init(&job->state, TEXTURE_PENDING);
+
+    // Só o cabeçalho, para agrupar as texturas de mesmo tamanho antes de decodificar
+    if (!stbi_info(path, &job->infoWidth, &job->infoHeight, &job->infoChannels)) {
+        job->infoWidth = job->infoHeight = job->infoChannels = 0;
+    }
+    return textureCount;
+}
+
+// Dimensões e posição de cada nível da cadeia de mipmaps até 1x1.
+// Retorna o número de níveis e o total de bytes em *totalBytes.
+static int computeLevels(int width, int height, int channels, int levelWidth[],
+                         int levelHeight[], size_t levelOffset[], size_t* totalBytes) {
+    size_t total = 0;
+    int levels = 0;
+    for (int w = width, h = height; levels < MAX_TEXTURE_LEVELS; levels++) {
+        levelWidth[levels] = w;
+        levelHeight[levels] = h;
+        levelOffset[levels] = total;
+        total += (size_t)w * h * channels;
+        if (w == 1 && h == 1) {
+            levels++;
+            break;
+        }
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    *totalBytes = total;
+    return levels;
+}
+
+// Reduz um nível à metade com média de blocos 2x2 (linhas ou colunas ímpares
+// repetem o último pixel)
+static void downsample(const unsigned char* src, int srcWidth, int srcHeight,
+                       unsigned char* dst, int dstWidth, int dstHeight, int channels) {
+    for (int y = 0; y < dstHeight; y++) {
+        int y0 = y * 2;
+        int y1 = y0 + 1 < srcHeight ? y0 + 1 : y0;
+        for (int x = 0; x < dstWidth; x++) {
+            int x0 = x * 2;
+            int x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+            const unsigned char* p00 = src + ((size_t)y0 * srcWidth + x0) * channels;
+            const unsigned char* p01 = src + ((size_t)y0 * srcWidth + x1) * channels;
+            const unsigned char* p10 = src + ((size_t)y1 * srcWidth + x0) * channels;
+            const unsigned char* p11 = src + ((size_t)y1 * srcWidth + x1) * channels;
+            unsigned char* out = dst + ((size_t)y * dstWidth + x) * channels;
+            for (int c = 0; c < channels; c++) {
+                out[c] = (unsigned char)((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+            }
+        }
+    }
+}
+
+// Nome do arquivo de cache: hash FNV-1a do caminho de origem
+static void cacheFileName(const char* path, char* out, size_t size) {
+    uint32_t h = 2166136261u;
+    for (const char* c = path; *c; c++) {
+        h ^= (unsigned char)*c;
+        h *= 16777619u;
+    }
+    snprintf(out, size, "%s/%08x.tex", TEXTURE_CACHE_DIR, h);
+}
+
+// Mapeia o cache da textura se ele existir e corresponder ao arquivo de origem atual
+static bool mapTextureCache(TextureJob* job, const struct stat* source) {
+    char cacheName[64];
+    cacheFileName(job->path, cacheName, sizeof(cacheName));
+    int fd = open(cacheName, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TextureCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    const TextureCacheHeader* header = mapping;
+    bool valid = header->magic == TEXTURE_CACHE_MAGIC
+              && header->version == TEXTURE_CACHE_VERSION
+              && strncmp(header->sourcePath, job->path, sizeof(header->sourcePath)) == 0
+              && header->sourceMtime == (int64_t)source->st_mtime
+              && header->sourceSize == (int64_t)source->st_size
+              && header->channels >= 1 && header->channels <= 4
+              && header->levelCount >= 1 && header->levelCount <= MAX_TEXTURE_LEVELS
+              && header->dataSize == (uint64_t)info.st_size - sizeof(TextureCacheHeader);
+
+    size_t total = 0;
+    for (int level = 0; valid && level < header->levelCount; level++) {
+        job->levelWidth[level] = header->levelWidth[level];
+        job->levelHeight[level] = header->levelHeight[level];
+        job->levelOffset[level] = total;
+        total += (size_t)header->levelWidth[level] * header->levelHeight[level] * header->channels;
+    }
+    if (!valid || total != header->dataSize) {
+        munmap(mapping, (size_t)info.st_size);
+        return false;
+    }
+
+    job->channels = header->channels;
+    job->levelCount = header->levelCount;
+    job->pixels = (unsigned char*)mapping + sizeof(TextureCacheHeader);
+    job->mapping = mapping;
+    job->mappingSize = (size_t)info.st_size;
+    job->stagingBytes = job->mappingSize;
+    trackMemory(MEMORY_TEXTURE_STAGING, (long long)job->stagingBytes);
+    return true;
+}
+
+// Grava a cadeia de mipmaps decodificada. Escreve em um arquivo temporário e
+// renomeia, para outra execução nunca ler um cache pela metade.
+static void writeTextureCache(const TextureJob* job, const struct stat* source, size_t dataSize) {
+    char cacheName[64];
+    char tempName[96];
+    cacheFileName(job->path, cacheName, sizeof(cacheName));
+    snprintf(tempName, sizeof(tempName), "%s.%ld.tmp", cacheName, (long)getpid());
+
+    TextureCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TEXTURE_CACHE_MAGIC;
+    header.version = TEXTURE_CACHE_VERSION;
+    memcpy(header.sourcePath, job->path, strlen(job->path)); // path sempre cabe (vem do catálogo)
+    header.sourceMtime = (int64_t)source->st_mtime;
+    header.sourceSize = (int64_t)source->st_size;
+    header.channels = job->channels;
+    header.levelCount = job->levelCount;
+    for (int level = 0; level < job->levelCount; level++) {
+        header.levelWidth[level] = job->levelWidth[level];
+        header.levelHeight[level] = job->levelHeight[level];
+    }
+    header.dataSize = dataSize;
+
+    FILE* file = fopen(tempName, "wb");
+    if (!file) return;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+           && fwrite(job->pixels, 1, dataSize, file) == dataSize;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tempName, cacheName) != 0) {
+        fprintf(stderr, "Aviso: Falha ao gravar cache da textura %s\n", job->path);
+        remove(tempName);
+    }
+}
+
+// Carrega a textura do cache ou decodifica o arquivo, gera a cadeia completa de
+// mipmaps e atualiza o cache (executa nas threads). Retorna false em caso de erro.
+static bool decodeTexture(TextureJob* job) {
+    struct stat source;
+    if (stat(job->path, &source) != 0) return false;
+    if (mapTextureCache(job, &source)) return true;
+
+    int width, height, channels;
+    unsigned char* image = stbi_load(job->path, &width, &height, &channels, 0);
+    if (!image) return false;
+
+    size_t total;
+    int levels = computeLevels(width, height, channels, job->levelWidth, job->levelHeight,
+                               job->levelOffset, &total);
+
+    unsigned char* pixels = malloc(total);
+    if (!pixels) {
+        stbi_image_free(image);
+        return false;
+    }
+    memcpy(pixels, image, (size_t)width * height * channels);
+    stbi_image_free(image);
+
+    for (int level = 1; level < levels; level++) {
+        downsample(pixels + job->levelOffset[level - 1],
+                   job->levelWidth[level - 1], job->levelHeight[level - 1],
+                   pixels + job->levelOffset[level],
+                   job->levelWidth[level], job->levelHeight[level], channels);
+    }
+
+    job->channels = channels;
+    job->levelCount = levels;
+    job->pixels = pixels;
+    job->stagingBytes = total;
+    trackMemory(MEMORY_TEXTURE_STAGING, (long long)total);
+    writeTextureCache(job, &source, total);
+    return true;
+}
+
+static void* textureWorker(void* unused) {
+    (void)unused;
+    traceThreadName("texturas");
+    // Prioridade menor que a da thread do OpenGL: com poucos núcleos a decodificação
+    // não pode atrasar os primeiros quadros (no Linux a prioridade é por thread)
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), TEXTURE_WORKER_NICE);
+    int i;
+    while ((i = atomic_fetch_add(&nextJob, 1)) < textureCount) {
+        TextureJob* job = &textures[i];
+        const char* fileName = strrchr(job->path, '/');
+        traceBegin(fileName ? fileName + 1 : job->path);
+        bool ok = decodeTexture(job);
+        traceEnd();
+        // O arquivo pode ter mudado de tamanho depois de ser agrupado no array
+        if (ok && job->array >= 0) {
+            const SurfaceArray* array = &surfaceArrays[job->array];
+            ok = job->levelWidth[0] == array->width && job->levelHeight[0] == array->height
+              && job->channels == array->channels;
+        }
+        atomic_store(&job->state, ok ? TEXTURE_DECODED : TEXTURE_FAILED);
+    }
+    return NULL;
+}
+
+static double elapsedMs(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static const GLenum textureFormats[] = { 0, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+
+// Primeiro nível que cabe no limite de tamanho da placa
+static int firstFittingLevel(const int levelWidth[], const int levelHeight[], int levelCount) {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    int base = 0;
+    while (base < levelCount - 1 && (levelWidth[base] > maxSize || levelHeight[base] > maxSize)) {
+        base++;
+    }
+    return base;
+}
+
+// Distribui as texturas em arrays por tamanho e formato. Os níveis de cada array só
+// são reservados quando a primeira camada chega a eles: reservar tudo de uma vez
+// (centenas de MB nos maiores) atrasava o primeiro quadro.
+static void createSurfaceArrays(void) {
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    surfaceArrays = calloc(textureCount, sizeof(SurfaceArray));
+    if (!surfaceArrays) return;
+
+    for (int i = 0; i < textureCount; i++) {
+        TextureJob* job = &textures[i];
+        if (job->infoWidth == 0) continue; // Arquivo ilegível: falha na decodificação
+
+        int a = 0;
+        while (a < surfaceArrayCount
+               && (surfaceArrays[a].width != job->infoWidth || surfaceArrays[a].height != job->infoHeight
+                   || surfaceArrays[a].channels != job->infoChannels || surfaceArrays[a].layers >= maxLayers)) {
+            a++;
+        }
+        if (a == surfaceArrayCount) {
+            surfaceArrays[a].width = job->infoWidth;
+            surfaceArrays[a].height = job->infoHeight;
+            surfaceArrays[a].channels = job->infoChannels;
+            surfaceArrayCount++;
+        }
+        job->array = a;
+        job->layer = surfaceArrays[a].layers++;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int a = 0; a < surfaceArrayCount; a++) {
+        SurfaceArray* array = &surfaceArrays[a];
+        size_t levelOffset[MAX_TEXTURE_LEVELS], total;
+        array->levelCount = computeLevels(array->width, array->height, array->channels,
+                                          array->levelWidth, array->levelHeight, levelOffset, &total);
+        array->baseLevel = firstFittingLevel(array->levelWidth, array->levelHeight, array->levelCount);
+        array->allocatedLevel = array->levelCount;
+
+        glGenTextures(1, &array->id);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array->id);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, array->levelCount - 1 - array->baseLevel);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void startTextureLoading(bool useArrays) {
+    if (loadingStarted) return;
+    loadingStarted = true;
+    clock_gettime(CLOCK_MONOTONIC, &loadingStart);
+    if (textureCount == 0) return;
+
+    if (useArrays) {
+        createSurfaceArrays();
+    }
+    for (int i = 0; i < textureCount; i++) {
+        if (textures[i].array < 0) {
+            glGenTextures(1, &textures[i].id);
+        }
+    }
+
+    // Uma thread por núcleo, sem passar do número de texturas
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threadCount = cores > 0 ? (int)cores : 1;
+    if (threadCount > textureCount) threadCount = textureCount;
+    if (threadCount > MAX_TEXTURE_THREADS) threadCount = MAX_TEXTURE_THREADS;
+
+    mkdir(TEXTURE_CACHE_DIR, 0755); // Pode já existir
+    atomic_store(&nextJob, 0);
+    for (int t = 0; t < threadCount; t++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, textureWorker, NULL) == 0) {
+            pthread_detach(thread);
+        }
+    }
+}
+
+static TextureJob* findTexture(int texture) {
+    if (texture <= 0 || texture > textureCount) return NULL;
+    return &textures[texture - 1];
+}
+
+void requestTextureDetail(int texture, float pixelDiameter) {
+    TextureJob* job = findTexture(texture);
+    if (job && pixelDiameter > job->wantedPixels) {
+        job->wantedPixels = pixelDiameter;
+    }
+}
+
+bool textureReady(int texture) {
+    TextureJob* job = findTexture(texture);
+    return job && job->prepared && job->residentLevel < job->levelCount;
+}
+
+GLuint textureObject(int texture) {
+    TextureJob* job = findTexture(texture);
+    if (!job) return 0;
+    return job->array >= 0 ? surfaceArrays[job->array].id : job->id;
+}
+
+int textureLayer(int texture) {
+    TextureJob* job = findTexture(texture);
+    return job ? job->layer : -1;
+}
+
+// Relativo ao GL_TEXTURE_BASE_LEVEL atual: no array, o nível mais detalhado reservado
+float textureMinLod(int texture) {
+    TextureJob* job = findTexture(texture);
+    if (!job) return 0.0f;
+    if (job->array >= 0) return (float)(job->residentLevel - surfaceArrays[job->array].allocatedLevel);
+    return (float)(job->residentLevel - job->baseLevel);
+}
+
+// Nível mais detalhado que vale a pena enviar: a metade visível da esfera mostra
+// metade da largura da textura, então bastam 2 texels por pixel de diâmetro.
+// Sempre pelo menos a miniatura.
+static int targetLevel(const TextureJob* job) {
+    if (uploadAllLevels) return job->baseLevel;
+    int level = job->levelCount - 1;
+    while (level > job->baseLevel && job->levelWidth[level - 1] <= TEXTURE_THUMBNAIL_SIZE) {
+        level--;
+    }
+    float wantedWidth = 2.0f * job->wantedPixels;
+    while (level > job->baseLevel && job->levelWidth[level] < wantedWidth) {
+        level--;
+    }
+    return level;
+}
+
+// Estimativa do que um nível ocupa no OpenGL: RGB costuma ser guardado com 4 bytes
+// por texel
+static size_t glLevelBytes(int width, int height, int channels, int layers) {
+    return (size_t)width * height * layers * (channels == 3 ? 4 : channels);
+}
+
+// Bytes novos no OpenGL para enviar o nível: o próprio nível, ou no array os
+// níveis que ainda precisam ser reservados para todas as camadas
+static size_t uploadCost(const TextureJob* job, int level) {
+    if (job->array < 0) {
+        return glLevelBytes(job->levelWidth[level], job->levelHeight[level], job->channels, 1);
+    }
+    const SurfaceArray* array = &surfaceArrays[job->array];
+    size_t bytes = 0;
+    for (int l = level; l < array->allocatedLevel; l++) {
+        bytes += glLevelBytes(array->levelWidth[l], array->levelHeight[l], array->channels, array->layers);
+    }
+    return bytes;
+}
+
+// Envia um nível e passa a usá-lo como o mais detalhado da textura
+static void uploadLevel(TextureJob* job, int level) {
+    GLenum format = textureFormats[job->channels];
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Camada de um array: o shader limita a amostragem aos níveis já presentes
+    if (job->array >= 0) {
+        SurfaceArray* array = &surfaceArrays[job->array];
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array->id);
+        // Os níveis são enviados do menor para o maior, então os reservados formam
+        // sempre uma faixa contínua até o menor; a base da textura acompanha a faixa
+        // para ela continuar completa
+        while (array->allocatedLevel > level) {
+            int newLevel = --array->allocatedLevel;
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, newLevel - array->baseLevel, format,
+                         array->levelWidth[newLevel], array->levelHeight[newLevel], array->layers, 0,
+                         format, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, newLevel - array->baseLevel);
+            trackMemory(MEMORY_TEXTURE_GL, (long long)glLevelBytes(array->levelWidth[newLevel],
+                        array->levelHeight[newLevel], array->channels, array->layers));
+        }
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level - job->baseLevel, 0, 0, job->layer,
+                        job->levelWidth[level], job->levelHeight[level], 1,
+                        format, GL_UNSIGNED_BYTE, job->pixels + job->levelOffset[level]);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        job->residentLevel = level;
+        return;
+    }
+
+    bindTexture2D(job->id);
+    if (job->residentLevel == job->levelCount) {
+        // Configurar parâmetros de wrapping e filtragem da textura
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, job->levelCount - 1 - job->baseLevel);
+    }
+    glTexImage2D(GL_TEXTURE_2D, level - job->baseLevel, format,
+                 job->levelWidth[level], job->levelHeight[level], 0,
+                 format, GL_UNSIGNED_BYTE, job->pixels + job->levelOffset[level]);
+    // Amostrar apenas os níveis já presentes
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - job->baseLevel);
+    job->residentLevel = level;
+    trackMemory(MEMORY_TEXTURE_GL, (long long)uploadCost(job, level));
+}
+
+// Libera a cópia na CPU quando todos os níveis já estão no OpenGL
+static void releasePixels(TextureJob* job) {
+    if (job->mapping) {
+        munmap(job->mapping, job->mappingSize);
+        job->mapping = NULL;
+    } else {
+        free(job->pixels);
+    }
+    job->pixels = NULL;
+    trackMemory(MEMORY_TEXTURE_STAGING, -(long long)job->stagingBytes);
+    job->stagingBytes = 0;
+}
+
+// Um nível descartado voltou a ser pedido depois de os pixels já terem sido
+// liberados: mapeia o cache de novo (se ele não existir, fica com o que tem)
+static bool reloadPixels(TextureJob* job) {
+    if (job->cacheMissing) return false;
+    struct stat source;
+    if (stat(job->path, &source) != 0 || !mapTextureCache(job, &source)) {
+        fprintf(stderr, "Aviso: Sem cache para reenviar os níveis da textura %s\n", job->path);
+        job->cacheMissing = true;
+        return false;
+    }
+    return true;
+}
+
+// Decodificada, preparada e com algum nível no OpenGL ou a caminho
+static bool textureUsable(const TextureJob* job) {
+    return job->prepared && atomic_load(&job->state) == TEXTURE_DECODED;
+}
+
+// Quanto libera descartar o nível mais detalhado de uma textura própria, ou o mais
+// detalhado reservado de um array, sem faltar ao que foi pedido neste quadro (0 se
+// não puder)
+static size_t evictableBytes(const TextureJob* job) {
+    if (!textureUsable(job) || job->residentLevel >= targetLevel(job)) return 0;
+    int level = job->residentLevel;
+    return glLevelBytes(job->levelWidth[level], job->levelHeight[level], job->channels, 1);
+}
+
+static size_t evictableArrayBytes(int a) {
+    const SurfaceArray* array = &surfaceArrays[a];
+    int level = array->allocatedLevel;
+    if (level >= array->levelCount - 1) return 0;
+    for (int i = 0; i < textureCount; i++) {
+        if (textures[i].array == a && textureUsable(&textures[i]) && targetLevel(&textures[i]) <= level) {
+            return 0;
+        }
+    }
+    return glLevelBytes(array->levelWidth[level], array->levelHeight[level], array->channels, array->layers);
+}
+
+// Solta o nível do OpenGL (tamanho zero) e sobe a base da textura
+static void evictLevel(TextureJob* job) {
+    int level = job->residentLevel;
+    GLenum format = textureFormats[job->channels];
+    bindTexture2D(job->id);
+    glTexImage2D(GL_TEXTURE_2D, level - job->baseLevel, format, 0, 0, 0, format, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1 - job->baseLevel);
+    job->residentLevel = level + 1;
+}
+
+static void evictArrayLevel(int a) {
+    SurfaceArray* array = &surfaceArrays[a];
+    int level = array->allocatedLevel++;
+    GLenum format = textureFormats[array->channels];
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array->id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level - array->baseLevel, format, 0, 0, 0, 0,
+                 format, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, level + 1 - array->baseLevel);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    for (int i = 0; i < textureCount; i++) {
+        if (textures[i].array == a && textures[i].residentLevel == level) {
+            textures[i].residentLevel = level + 1;
+        }
+    }
+}
+
+static bool fitsMemoryBudget(const TextureJob* job, int level) {
+    return memoryBudget == 0 || (size_t)memoryUsage(MEMORY_TEXTURE_GL) + uploadCost(job, level) <= memoryBudget;
+}
+
+// Descarta níveis que ninguém pediu neste quadro, sempre o maior disponível, até o
+// uso ficar em limit. A miniatura nunca é descartada.
+static void evictDownTo(size_t limit) {
+    while ((size_t)memoryUsage(MEMORY_TEXTURE_GL) > limit) {
+        size_t largest = 0;
+        int texture = -1, array = -1;
+        for (int i = 0; i < textureCount; i++) {
+            size_t bytes = textures[i].array < 0 ? evictableBytes(&textures[i]) : 0;
+            if (bytes > largest) {
+                largest = bytes;
+                texture = i;
+            }
+        }
+        for (int a = 0; a < surfaceArrayCount; a++) {
+            size_t bytes = evictableArrayBytes(a);
+            if (bytes > largest) {
+                largest = bytes;
+                array = a;
+                texture = -1;
+            }
+        }
+        if (largest == 0) return;
+
+        if (texture >= 0) {
+            evictLevel(&textures[texture]);
+        } else {
+            evictArrayLevel(array);
+        }
+        trackMemory(MEMORY_TEXTURE_GL, -(long long)largest);
+        evictedLevels++;
+    }
+}
+
+// Abre espaço para o nível pedido descartando o que não foi pedido
+static bool makeRoomFor(const TextureJob* job, int level) {
+    if (fitsMemoryBudget(job, level)) return true;
+    size_t cost = uploadCost(job, level);
+    if (cost > memoryBudget) return false;
+    evictDownTo(memoryBudget - cost);
+    return fitsMemoryBudget(job, level);
+}
+
+bool streamTextures(void) {
+    size_t uploaded = 0;
+    bool pending = false;
+    if (memoryBudget > 0) evictDownTo(memoryBudget);
+
+    for (int i = 0; i < textureCount; i++) {
+        TextureJob* job = &textures[i];
+        if (!job->prepared) {
+            // Primeira vez que a thread do OpenGL vê o resultado da decodificação
+            int state = atomic_load(&job->state);
+            if (state == TEXTURE_PENDING) continue;
+            job->prepared = true;
+            finishedCount++;
+            if (finishedCount == textureCount) {
+                printf("Texturas: %d decodificadas em %.1f ms\n", textureCount, elapsedMs(&loadingStart));
+            }
+            if (state == TEXTURE_FAILED) {
+                fprintf(stderr, "Falha ao carregar textura: %s\n", job->path);
+                if (job->id) glDeleteTextures(1, &job->id);
+                job->id = 0;
+                continue;
+            }
+
+            // Pular os níveis maiores que o limite da placa
+            if (job->array >= 0) {
+                job->baseLevel = surfaceArrays[job->array].baseLevel;
+            } else {
+                job->baseLevel = firstFittingLevel(job->levelWidth, job->levelHeight, job->levelCount);
+            }
+            job->residentLevel = job->levelCount;
+        }
+        // Texturas que falharam não têm níveis para enviar
+        if (!textureUsable(job)) continue;
+
+        // Sem pixels na CPU: tudo já foi enviado, ou, com limite de memória, o que
+        // foi pedido já estava lá (e pode ser relido do cache se o pedido crescer)
+        int target = targetLevel(job);
+        if (!job->pixels && (job->residentLevel <= target || !makeRoomFor(job, job->residentLevel - 1)
+                             || !reloadPixels(job))) {
+            continue;
+        }
+
+        // Do menor para o maior nível, até o alvo ou até acabar o orçamento do quadro.
+        // O que não cabe no limite de memória fica de fora até sobrar espaço.
+        bool overBudget = false;
+        while (job->residentLevel > target) {
+            int level = job->residentLevel - 1;
+            size_t bytes = (size_t)job->levelWidth[level] * job->levelHeight[level] * job->channels;
+            if (!uploadAllLevels && uploaded > 0 && uploaded + bytes > TEXTURE_UPLOAD_BUDGET) break;
+            if (!makeRoomFor(job, level)) {
+                overBudget = true;
+                break;
+            }
+            uploadLevel(job, level);
+            uploaded += bytes;
+        }
+        if (job->residentLevel > target && !overBudget) pending = true;
+        if (job->residentLevel == job->baseLevel
+            || (memoryBudget > 0 && (job->residentLevel <= target || overBudget))) {
+            releasePixels(job);
+        }
+    }
+
+    for (int i = 0; i < textureCount; i++) {
+        textures[i].wantedPixels = 0.0f;
+    }
+    return pending || finishedCount < textureCount;
+}
+
+void setTextureMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+}
+
+int evictedTextureLevels(void) {
+    return evictedLevels;
+}
+
+void finishTextureLoading(void) {
+    uploadAllLevels = true;
+    if (!loadingStarted) return;
+    traceBegin("esperar texturas");
+    struct timespec pause = { 0, 1000000 }; // 1 ms
+    for (;;) {
+        streamTextures();
+        if (finishedCount == textureCount) break;
+        nanosleep(&pause, NULL);
+    }
+    traceEnd();
+}
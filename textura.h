@@ -0,0 +1,61 @@
+#ifndef TEXTURA_H
+#define TEXTURA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+
+// Carregamento progressivo de texturas: os arquivos são registrados durante a
+// leitura do catálogo, decodificados em segundo plano e enviados ao OpenGL aos
+// poucos, primeiro uma miniatura e depois os níveis maiores que forem pedidos.
+// Enquanto textureReady() for falso o corpo deve ser desenhado com sua cor.
+//
+// Com arrays ativados, texturas de mesmo tamanho ficam em camadas de um único
+// GL_TEXTURE_2D_ARRAY; sem eles, cada arquivo vira uma GL_TEXTURE_2D própria.
+
+// Registra um arquivo de textura e devolve seu identificador (o mesmo para arquivos
+// repetidos, 0 se não houver). Só pode ser chamada antes de startTextureLoading().
+int requestTexture(const char* path);
+
+// Cria as texturas no OpenGL e começa a decodificar os arquivos registrados e gerar
+// os mipmaps em várias threads (uma por núcleo), sem esperar terminar
+void startTextureLoading(bool useArrays);
+
+// Pede detalhe suficiente para a textura aparecer com o diâmetro dado em pixels
+// neste quadro. Texturas sem pedido ficam só com a miniatura.
+void requestTextureDetail(int texture, float pixelDiameter);
+
+// Envia ao OpenGL os níveis pedidos que já foram decodificados, dentro do orçamento
+// de bytes por quadro, e zera os pedidos. Chamar uma vez por quadro. Retorna true
+// se ainda falta trabalho (decodificações ou níveis que ficaram para o próximo quadro).
+bool streamTextures(void);
+
+// Espera todas as texturas serem decodificadas e envia todos os níveis de uma vez,
+// sem orçamento por quadro. Usada no modo sem janela, onde cada quadro gravado
+// deve sair com o detalhe completo.
+void finishTextureLoading(void);
+
+// Limite para a memória de textura no OpenGL (estimada, ver memoria.h), 0 = sem
+// limite. Acima dele, os níveis mais detalhados que não foram pedidos no quadro são
+// descartados, e os pedidos que não cabem ficam com menos detalhe até sobrar espaço.
+// Um nível descartado e pedido de novo é relido do cache de texturas.
+void setTextureMemoryBudget(size_t bytes);
+
+// Quantos níveis o limite de memória já descartou
+int evictedTextureLevels(void);
+
+// Se a textura já tem algum nível no OpenGL e pode ser usada para desenhar
+bool textureReady(int texture);
+
+// Nome GL da textura: um GL_TEXTURE_2D_ARRAY se textureLayer() >= 0, senão uma GL_TEXTURE_2D
+GLuint textureObject(int texture);
+
+// Camada da textura no array, -1 se ela não estiver em um
+int textureLayer(int texture);
+
+// Nível de mipmap mais detalhado já enviado (o shader não deve amostrar abaixo dele)
+float textureMinLod(int texture);
+
+#endif